@@ -0,0 +1,28 @@
+#! /usr/bin/bash
+
+# Startup and memory of the real-world queries compiled by the JIT against
+# compiled ahead of time: aot_build compiles into a fresh object directory,
+# aot_load runs again on the objects the build left there. Prints
+# "testcase,mode,compile_ms,peak_rss_mb,throughput" per run.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+AOT_DIR=${AOT_DIR:-aot_objects}
+
+rm -rf $AOT_DIR
+mkdir -p $AOT_DIR
+
+for testcase in normalize fillmean resample algotrading rsi pantom kurtosis largeqty
+do
+    for mode in jit aot_build aot_load
+    do
+        flags=""
+        if [[ $mode != jit ]]; then
+            flags="--aot=$AOT_DIR"
+        fi
+        ./build/main $testcase $SIZE $THREADS $flags "$@" \
+            | awk -F, -v tc=$testcase -v m=$mode \
+                '/Throughput/ { tp = $4 } /Compile/ { ms = $5 } /PeakRSS/ { rss = $4 } END { print tc "," m "," ms "," rss "," tp }' \
+            | tr -d ' '
+    done
+done
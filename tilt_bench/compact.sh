@@ -0,0 +1,23 @@
+#! /usr/bin/bash
+
+# Compiled where against the compress-store kernels at every scalar payload
+# width. THRESHOLD sets the selectivity: the synthetic values lie in
+# (-200, 0), so -200, -150 and -100 keep about all, 3/4 and 1/2 of the events.
+# Prints "type,threshold,kernel,throughput" per run.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for type in i8 i16 i32 i64 f32 f64
+do
+    for threshold in -200 -150 -100 0
+    do
+        ./build/main width_where_$type $SIZE $THREADS --threshold=$threshold "$@" \
+            | awk -F, -v ty=$type -v th=$threshold '/Throughput/ { print ty "," th ",compiled," $4 }' | tr -d ' '
+        for simd in scalar avx2 avx512
+        do
+            ./build/main compactwhere_$type $SIZE $THREADS --threshold=$threshold --simd=$simd "$@" \
+                | awk -F, -v ty=$type -v th=$threshold -v k=$simd '/Throughput/ { print ty "," th "," k "," $4 }' | tr -d ' '
+        done
+    done
+done
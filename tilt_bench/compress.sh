@@ -0,0 +1,16 @@
+#! /usr/bin/bash
+
+# Plain vs frame-of-reference (TiLT) vs bit-packed (native) integer columns.
+# Prints "testcase,throughput,bytes_per_event" per run.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for testcase in select64 where64 sum64 \
+    forselect64 forwhere64 forsum64 forselect32 forwhere32 forsum32 \
+    packedselect64 packedwhere64 packedsum64 packedselect32 packedwhere32 packedsum32
+do
+    ./build/main $testcase $SIZE $THREADS \
+        | awk -F, -v t=$testcase '/Throughput/ { tp = $4 } /Bytes/ { bpe = $4 } END { print t "," tp "," bpe }' \
+        | tr -d ' '
+done
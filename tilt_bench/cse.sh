@@ -0,0 +1,17 @@
+#! /usr/bin/bash
+
+# Queries with duplicate reductions (eg3, eg5, eg6) against eg7, which has
+# none, with and without their elimination. Prints
+# "testcase,cse,throughput,eliminated" per run.
+
+SIZE=${SIZE:-100000000}
+
+for testcase in eg3 eg5 eg6 eg7
+do
+    for cse in 0 1
+    do
+        ./build/main $testcase $SIZE 1 --cse=$cse "$@" \
+            | awk -F, -v tc=$testcase -v c=$cse '/Throughput/ { tp = $4 } /CSE/ { n = $4 } END { print tc "," c "," tp "," n + 0 }' \
+            | tr -d ' '
+    done
+done
@@ -0,0 +1,17 @@
+#! /usr/bin/bash
+
+# Compiled queries with materialized intermediate regions against their fused
+# kernels. Prints "testcase,throughput,eliminated_mb,ring_bytes" per run.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+
+for query in pantom normalize
+do
+    for testcase in $query ${query}_stream
+    do
+        ./build/main $testcase $SIZE $THREADS "$@" \
+            | awk -F, -v tc=$testcase '/Throughput/ { tp = $4 } /Fusion/ { mb = $4 / 1e6; ring = $5 } END { print tc "," tp "," mb + 0 "," ring + 0 }' \
+            | tr -d ' '
+    done
+done
@@ -0,0 +1,21 @@
+#! /usr/bin/bash
+
+# Explicit vs implicit (run-length) timelines on select / where / tumbling sum.
+# Both sides are native loops; the explicit* baselines walk a region_t the way
+# the implicit* kernels walk runs. Prints "testcase,throughput,bytes_per_event"
+# per run; pass e.g. --missing=0.1 to break the stream into several runs.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for testcase in explicitselect explicitselect8 explicitselect64 \
+    explicitwhere explicitwhere8 explicitwhere64 \
+    explicitsum explicitsum8 explicitsum64 \
+    implicitselect implicitselect8 implicitselect64 \
+    implicitwhere implicitwhere8 implicitwhere64 \
+    implicitsum implicitsum8 implicitsum64
+do
+    ./build/main $testcase $SIZE $THREADS "$@" \
+        | awk -F, -v t=$testcase '/Throughput/ { tp = $4 } /Bytes/ { bpe = $4 } END { print t "," tp "," bpe }' \
+        | tr -d ' '
+done
@@ -0,0 +1,19 @@
+#! /usr/bin/bash
+
+# Imputation throughput against the fraction of missing input slots.
+# Prints one "op,missing,burst,throughput" line per run.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+BURST=${BURST:-1}
+
+for op in fillmean ffill bfill interp
+do
+    for missing in 0 0.01 0.05 0.1 0.2 0.3 0.5 0.7 0.9
+    do
+        ./build/main $op $SIZE $THREADS --missing=$missing --burst=$BURST \
+            | grep "Throughput(M/s)" \
+            | awk -F, -v op=$op -v m=$missing -v b=$BURST '{ print op "," m "," b "," $4 }' \
+            | tr -d ' '
+    done
+done
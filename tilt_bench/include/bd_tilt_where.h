@@ -57,8 +57,8 @@ private:
 
     void init() final
     {
-        base_reg = create_reg<int64_t>(size/window + 1);
-        delta_reg = create_reg<int8_t>(size);
+        base_reg = create_in_reg<int64_t>(size/window + 1);
+        delta_reg = create_in_reg<int8_t>(size);
         out_reg = create_reg<int64_t>(size);
 
         SynthData<int64_t> base_dataset(window, size/window + 1);
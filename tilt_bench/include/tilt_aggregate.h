@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_reduce.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -14,6 +15,15 @@ public:
         period(period), size(size), w(w)
     {}
 
+    bool partitionable() override { return true; }
+
+    // the tumbling sum kernel with one lane, as the generated code folds
+    intptr_t tier0() override
+    {
+        tumble_window<SumRed<float>> = w;
+        return reinterpret_cast<intptr_t>(&tumble_scalar<SumRed<float>>);
+    }
+
 private:
     Op query() final
     {
@@ -23,18 +33,23 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         float osize = (float)size / (float)w;
-        out_reg = create_reg<float>(ceil(osize));
+        out_reg = create_out_reg<float>(ceil(osize), size);
 
         SynthData<float> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<float>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, w, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_window_sum<float>(&in_reg, w, period * size));
     }
 
     void release() final
@@ -73,6 +88,15 @@ public:
         period(period), size(size), w(w)
     {}
 
+    bool partitionable() override { return true; }
+
+    // the tumbling sum kernel with one lane, as the generated code folds
+    intptr_t tier0() override
+    {
+        tumble_window<SumRed<int64_t>> = w;
+        return reinterpret_cast<intptr_t>(&tumble_scalar<SumRed<int64_t>>);
+    }
+
 private:
     Op query() final
     {
@@ -82,18 +106,23 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
+        in_reg = create_in_reg<int64_t>(size);
         float osize = (float)size / (float)w;
-        out_reg = create_reg<int64_t>(ceil(osize));
+        out_reg = create_out_reg<int64_t>(ceil(osize), size);
 
         SynthData<int64_t> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<int64_t>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, w, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_window_sum<int64_t>(&in_reg, w, period * size));
     }
 
     void release() final
@@ -130,6 +159,15 @@ public:
         period(period), size(size), w(w)
     {}
 
+    bool partitionable() override { return true; }
+
+    // the tumbling sum kernel with one lane, as the generated code folds
+    intptr_t tier0() override
+    {
+        tumble_window<SumRed<int8_t>> = w;
+        return reinterpret_cast<intptr_t>(&tumble_scalar<SumRed<int8_t>>);
+    }
+
 private:
     Op query() final
     {
@@ -139,18 +177,23 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int8_t>(size);
+        in_reg = create_in_reg<int8_t>(size);
         float osize = (float)size / (float)w;
-        out_reg = create_reg<int8_t>(ceil(osize));
+        out_reg = create_out_reg<int8_t>(ceil(osize), size);
 
         SynthData<int8_t> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<int8_t>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, w, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_window_sum<int8_t>(&in_reg, w, period * size));
     }
 
     void release() final
@@ -38,7 +38,7 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         out_reg = create_reg<float>(size);
 
         SynthData<float> dataset(period, size);
@@ -0,0 +1,229 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_AOT_H_
+#define TILT_BENCH_INCLUDE_TILT_AOT_H_
+
+#include <dlfcn.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+
+#include "tilt/codegen/loopgen.h"
+#include "tilt/codegen/llvmgen.h"
+#include "tilt/codegen/printer.h"
+
+using namespace std;
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Ahead-of-time compilation of queries to shared objects.
+ *
+ * With --aot=<dir>, compile_op does not JIT a query but looks it up in <dir>
+ * by a hash of its loop IR and the host CPU. On a miss the query is optimized
+ * as the JIT does, written to an object file and linked into <dir>/<hash>.so,
+ * which exports the C ABI entry
+ *
+ *   region_t* query(ts_t t_start, ts_t t_end, region_t* out, region_t* in, ...)
+ *
+ * with the regions in the order the benchmark passes them. On a hit the
+ * object is loaded with dlopen and LLVM is never started, so later runs pay
+ * no code generation and do not hold the JIT in memory. The objects target
+ * the CPU they were built on, as the JIT does. aot_load() is all a runtime
+ * needs to run a shipped object, and the generated code resolves the TiLT
+ * runtime against the symbols of the executable that loads it. */
+
+// Directory of the compiled queries, set once from the main.cpp flag
+// --aot=<dir>. Empty compiles with the JIT.
+inline string aot_dir;
+
+// Name of the entry function of every object
+inline const string kAotEntry = "query";
+
+// How the queries of the process were compiled and the time it took
+struct CompileStats {
+    int64_t us = 0;
+    int jit = 0;
+    int aot_built = 0;
+    int aot_loaded = 0;
+
+    string mode() const
+    {
+        if (aot_built > 0) {
+            return "aot_build";
+        } else if (aot_loaded > 0) {
+            return "aot_load";
+        }
+        return "jit";
+    }
+};
+
+inline CompileStats compile_stats;
+
+// Target features of the host CPU, as the JIT compiles for
+string aot_host_features()
+{
+    llvm::SubtargetFeatures features;
+    llvm::StringMap<bool> host_features;
+    if (llvm::sys::getHostCPUFeatures(host_features)) {
+        for (auto& f : host_features) {
+            features.AddFeature(f.first(), f.second);
+        }
+    }
+    return features.getString();
+}
+
+// Optimizes `mod` for the host CPU at -O3 and writes it as a position
+// independent object to `path`
+void aot_emit_object(llvm::Module* mod, const string& path)
+{
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto triple = llvm::sys::getProcessTriple();
+    string err;
+    auto target = llvm::TargetRegistry::lookupTarget(triple, err);
+    if (!target) {
+        throw runtime_error("No LLVM target for " + triple + ": " + err);
+    }
+    unique_ptr<llvm::TargetMachine> tm(target->createTargetMachine(triple, llvm::sys::getHostCPUName(),
+        aot_host_features(), llvm::TargetOptions(), llvm::Reloc::PIC_, llvm::None, llvm::CodeGenOpt::Aggressive));
+    mod->setTargetTriple(triple);
+    mod->setDataLayout(tm->createDataLayout());
+
+    llvm::PassManagerBuilder builder;
+    builder.OptLevel = 3;
+    builder.SizeLevel = 0;
+    builder.LoopVectorize = true;
+    builder.SLPVectorize = true;
+    tm->adjustPassManager(builder);
+
+    llvm::legacy::FunctionPassManager fpm(mod);
+    fpm.add(llvm::createTargetTransformInfoWrapperPass(tm->getTargetIRAnalysis()));
+    builder.populateFunctionPassManager(fpm);
+    fpm.doInitialization();
+    for (auto& fn : *mod) {
+        fpm.run(fn);
+    }
+    fpm.doFinalization();
+
+    llvm::legacy::PassManager mpm;
+    mpm.add(llvm::createTargetTransformInfoWrapperPass(tm->getTargetIRAnalysis()));
+    builder.populateModulePassManager(mpm);
+    mpm.run(*mod);
+
+    error_code ec;
+    llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_None);
+    if (ec) {
+        throw runtime_error("Cannot write " + path + ": " + ec.message());
+    }
+    llvm::legacy::PassManager emit;
+    if (tm->addPassesToEmitFile(emit, os, nullptr, llvm::CGFT_ObjectFile)) {
+        throw runtime_error("LLVM cannot emit objects for " + triple);
+    }
+    emit.run(*mod);
+    os.flush();
+}
+
+// A new empty file `prefix`.XXXXXX`suffix` with a name unique to this process
+string aot_temp(const string& prefix, const string& suffix)
+{
+    string name = prefix + ".XXXXXX" + suffix;
+    auto fd = mkstemps(&name[0], suffix.size());
+    if (fd < 0) {
+        throw runtime_error("Cannot create a file next to " + prefix);
+    }
+    close(fd);
+    return name;
+}
+
+// Compiles `loop` into the shared object `path`. The object is built under
+// names of this process and renamed into place, so runs building the same
+// query at once never load half of it.
+void aot_build(Loop loop, const string& path)
+{
+    llvm::LLVMContext ctx;
+    auto mod = LLVMGen::Build(loop, ctx);
+    auto obj = aot_temp(path, ".o");
+    auto tmp = aot_temp(path, ".tmp");
+    try {
+        aot_emit_object(mod.get(), obj);
+        auto cmd = "cc -shared -o '" + tmp + "' '" + obj + "'";
+        if (system(cmd.c_str()) != 0) {
+            throw runtime_error("Linking " + path + " failed: " + cmd);
+        }
+    } catch (...) {
+        remove(obj.c_str());
+        remove(tmp.c_str());
+        throw;
+    }
+    remove(obj.c_str());
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        throw runtime_error("Cannot move " + tmp + " to " + path);
+    }
+}
+
+// Address of the entry `name` of the shared object `path`. The object stays
+// loaded until the process exits, as compiled queries are reused by address.
+intptr_t aot_load(const string& path, const string& name = kAotEntry)
+{
+    static mutex m;
+    static vector<void*> handles;
+
+    auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        throw runtime_error("Cannot load " + path + ": " + dlerror());
+    }
+    auto addr = dlsym(handle, name.c_str());
+    if (!addr) {
+        dlclose(handle);
+        throw runtime_error("No entry " + name + " in " + path);
+    }
+    lock_guard<mutex> lk(m);
+    handles.push_back(handle);
+    return reinterpret_cast<intptr_t>(addr);
+}
+
+// Compiled `query_op` from aot_dir, built first if it is not there. The
+// object is looked up by its loop IR and the CPU it targets, so a directory
+// shared by hosts never runs code for features a host lacks.
+intptr_t aot_compile(Op query_op)
+{
+    auto query_op_sym = _sym(kAotEntry, query_op);
+    auto loop = LoopGen::Build(query_op_sym, query_op.get());
+
+    stringstream key;
+    key << hex << hash<string>()(IRPrinter::Build(loop) + "\n" + llvm::sys::getHostCPUName().str()
+        + "\n" + aot_host_features());
+    auto path = aot_dir + "/" + key.str() + ".so";
+    if (!ifstream(path).good()) {
+        aot_build(loop, path);
+        compile_stats.aot_built++;
+    } else {
+        compile_stats.aot_loaded++;
+    }
+    return aot_load(path);
+}
+
+#endif  // TILT_BENCH_INCLUDE_TILT_AOT_H_
@@ -0,0 +1,210 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_ARENA_H_
+#define TILT_BENCH_INCLUDE_TILT_ARENA_H_
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tilt/builder/tilder.h"
+
+using namespace std;
+using namespace tilt;
+
+/* Arena-backed state regions.
+ *
+ * The recursive operators of rsi, algotrading, largeqty, pantom, ffill and
+ * the pipelined stages keep their past outputs in the Aux state regions of
+ * the query, and columnar resample keeps its pair columns there. Instead of
+ * allocating each of them in init() with a size picked by hand, a benchmark
+ * takes them from the arena of its partition, sized from the entries the
+ * operator writes per invocation of the query and how far back the query
+ * reads its output, which aux_back() finds in the windows and points of the
+ * query. The arena keeps its chunks when the benchmark releases its regions,
+ * so later runs of the process (sweeps, repeated testcases) allocate
+ * nothing. */
+
+// Payload and timeline bytes of all state regions taken from the arenas
+inline int64_t arena_state_bytes = 0;
+
+// Ticks before the point it is evaluated at that `e` reads a stream matching
+// `reads`, through points and windows, or -1 if it does not. With `nested`
+// the operations nested in `e` count too.
+inline int64_t aux_reach(const Expr& e, const function<bool(const Symbol*)>& reads, bool nested)
+{
+    if (e == nullptr) {
+        return -1;
+    }
+    auto node = e.get();
+    if (auto elem = dynamic_cast<const Element*>(node)) {
+        return reads(elem->lstream.get()) ? -elem->pt.offset : -1;
+    } else if (auto subls = dynamic_cast<const SubLStream*>(node)) {
+        return reads(subls->lstream.get()) ? -subls->win.start.offset : -1;
+    } else if (auto op = dynamic_cast<const OpNode*>(node)) {
+        int64_t reach = -1;
+        if (nested) {
+            for (auto& def : op->syms) {
+                reach = max(reach, aux_reach(def.second, reads, true));
+            }
+        }
+        return reach;
+    } else if (auto red = dynamic_cast<const Reduce*>(node)) {
+        return max<int64_t>(reads(red->lstream.get()) ? 0 : -1, aux_reach(red->state, reads, nested));
+    } else if (auto nary = dynamic_cast<const NaryExpr*>(node)) {
+        int64_t reach = -1;
+        for (auto& arg : nary->args) {
+            reach = max(reach, aux_reach(arg, reads, nested));
+        }
+        return reach;
+    } else if (auto ifelse = dynamic_cast<const IfElse*>(node)) {
+        return max({aux_reach(ifelse->cond, reads, nested), aux_reach(ifelse->true_body, reads, nested),
+            aux_reach(ifelse->false_body, reads, nested)});
+    } else if (auto sel = dynamic_cast<const Select*>(node)) {
+        return max({aux_reach(sel->cond, reads, nested), aux_reach(sel->true_body, reads, nested),
+            aux_reach(sel->false_body, reads, nested)});
+    } else if (auto cast = dynamic_cast<const Cast*>(node)) {
+        return aux_reach(cast->arg, reads, nested);
+    } else if (auto get = dynamic_cast<const Get*>(node)) {
+        return aux_reach(get->input, reads, nested);
+    } else if (auto nw = dynamic_cast<const New*>(node)) {
+        int64_t reach = -1;
+        for (auto& input : nw->inputs) {
+            reach = max(reach, aux_reach(input, reads, nested));
+        }
+        return reach;
+    }
+    return -1;
+}
+
+// Events of the previous invocation that `query_op` reads back from the Aux
+// state bound to its Params input `input`: the furthest the operations of the
+// query reach into the stateful operation, its reads of its own output
+// included, in periods of the stateful operation
+inline int64_t aux_back(Op query_op, size_t input)
+{
+    auto state = query_op->inputs.at(input).get();
+    function<int64_t(const OpNode*)> find = [&find, state](const OpNode* op) -> int64_t {
+        for (auto& entry : op->aux) {
+            if (entry.second.get() != state) {
+                continue;
+            }
+            auto sym = entry.first.get();
+            auto sub = dynamic_cast<const OpNode*>(op->syms.at(entry.first).get());
+            auto by_sym = [sym](const Symbol* s) { return s == sym; };
+            auto by_out = [](const Symbol* s) { return dynamic_cast<const Out*>(s) != nullptr; };
+            int64_t ticks = aux_reach(op->pred, by_sym, true);
+            for (auto& def : op->syms) {
+                ticks = max(ticks, aux_reach(def.second, by_sym, true));
+            }
+            for (auto& def : sub->syms) {
+                ticks = max(ticks, aux_reach(def.second, by_out, false));
+            }
+            auto p = sub->iter.period;
+            return (max<int64_t>(ticks, 0) + p - 1) / p;
+        }
+        for (auto& def : op->syms) {
+            if (auto sub = dynamic_cast<const OpNode*>(def.second.get())) {
+                auto back = find(sub);
+                if (back >= 0) {
+                    return back;
+                }
+            }
+        }
+        return -1;
+    };
+    auto back = find(query_op.get());
+    if (back < 0) {
+        throw runtime_error("Input " + to_string(input) + " of the query is no Aux state");
+    }
+    return back;
+}
+
+class RegionArena {
+public:
+    // Arena of benchmark partition `part`. Every partition runs on a thread
+    // of its own, so an arena is never used by two threads at once.
+    static RegionArena* Get(int part)
+    {
+        static mutex m;
+        static map<int, unique_ptr<RegionArena>> arenas;
+        lock_guard<mutex> lk(m);
+        auto& arena = arenas[part];
+        if (!arena) {
+            arena.reset(new RegionArena());
+        }
+        return arena.get();
+    }
+
+    // Region of `width` byte payloads for an operator writing `len` events per
+    // invocation and reading its output `back` events into the previous one
+    region_t* state(int64_t width, int64_t len, int64_t back)
+    {
+        auto size = get_buf_size(len + back);
+        auto tl = reinterpret_cast<ival_t*>(take(size * sizeof(ival_t)));
+        auto data = take(size * width);
+        regions.emplace_back();
+        init_region(&regions.back(), 0, size, tl, data);
+        arena_state_bytes += size * (sizeof(ival_t) + width);
+        return &regions.back();
+    }
+
+    // Region of the Aux state bound to input `input` of `query_op`, reading
+    // back as far as the query reaches into it
+    region_t* state(int64_t width, int64_t len, Op query_op, size_t input)
+    {
+        return state(width, len, aux_back(query_op, input));
+    }
+
+    template<typename T>
+    region_t* state(int64_t len, Op query_op, size_t input)
+    {
+        return state(sizeof(T), len, query_op, input);
+    }
+
+    // Drops the regions and keeps the memory for the next ones
+    void reset()
+    {
+        regions.clear();
+        chunk = 0;
+        used = 0;
+    }
+
+private:
+    static constexpr int64_t kChunkSize = 1 << 20;
+    static constexpr int64_t kAlign = 64;
+
+    struct Chunk {
+        unique_ptr<char[]> buf;
+        char* base;
+        int64_t size;
+    };
+
+    char* take(int64_t bytes)
+    {
+        bytes = (bytes + kAlign - 1) / kAlign * kAlign;
+        while (chunk < chunks.size() && used + bytes > chunks[chunk].size) {
+            chunk++;
+            used = 0;
+        }
+        if (chunk == chunks.size()) {
+            auto size = max(kChunkSize, bytes);
+            unique_ptr<char[]> buf(new char[size + kAlign]);
+            auto base = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(buf.get()) + kAlign - 1) / kAlign * kAlign);
+            chunks.push_back(Chunk{move(buf), base, size});
+        }
+        auto ptr = chunks[chunk].base + used;
+        used += bytes;
+        return ptr;
+    }
+
+    vector<Chunk> chunks;
+    size_t chunk = 0;
+    int64_t used = 0;
+    deque<region_t> regions;
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_ARENA_H_
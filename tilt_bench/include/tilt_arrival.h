@@ -0,0 +1,238 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_ARRIVAL_H_
+#define TILT_BENCH_INCLUDE_TILT_ARRIVAL_H_
+
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tilt/builder/tilder.h"
+
+using namespace std;
+
+// Describes the timeline of a generated stream. Parsed from the main.cpp flags
+//   --arrival=periodic | jitter:<frac> | poisson | onoff:<burst events>:<duty> | trace:<file>
+//   --duration=full | fixed:<ticks> | exp:<mean ticks>
+//   --disorder=<max delay in ticks>
+//   --seed=<n>
+struct ArrivalSpec {
+    string process = "periodic";
+    double jitter = 0;          // jitter: max displacement as a fraction of the period
+    int64_t burst_events = 100; // onoff: mean number of events per burst
+    double duty = 0.1;          // onoff: fraction of the timeline spent in bursts
+    string trace;               // trace: whitespace separated inter-arrival gaps
+
+    string duration = "full";
+    double dur_ticks = 1;
+
+    dur_t disorder = 0;
+    uint64_t seed = 42;
+
+    static vector<string> split(const string& str)
+    {
+        vector<string> parts;
+        stringstream ss(str);
+        string part;
+        while (getline(ss, part, ':')) {
+            parts.push_back(part);
+        }
+        return parts;
+    }
+
+    void set_arrival(const string& str)
+    {
+        auto parts = split(str);
+        process = parts[0];
+        if (process == "periodic" || process == "poisson") {
+        } else if (process == "jitter" && parts.size() == 2) {
+            jitter = stod(parts[1]);
+        } else if (process == "onoff" && parts.size() == 3) {
+            burst_events = stol(parts[1]);
+            duty = stod(parts[2]);
+            if (burst_events < 1 || duty <= 0 || duty >= 1) {
+                throw runtime_error("Invalid arrival process " + str);
+            }
+        } else if (process == "trace" && parts.size() == 2) {
+            trace = parts[1];
+        } else {
+            throw runtime_error("Invalid arrival process " + str);
+        }
+    }
+
+    void set_duration(const string& str)
+    {
+        auto parts = split(str);
+        duration = parts[0];
+        if (duration == "full") {
+        } else if ((duration == "fixed" || duration == "exp") && parts.size() == 2) {
+            dur_ticks = stod(parts[1]);
+        } else {
+            throw runtime_error("Invalid duration " + str);
+        }
+    }
+
+    bool dense() const { return process == "periodic" && duration == "full"; }
+
+    // a short duration leaves a null interval in front of the event
+    int64_t entries_per_event() const { return (duration == "full") ? 1 : 2; }
+};
+
+// Timeline used by the datasets in tilt_bench.h, set once from main.cpp
+inline ArrivalSpec arrival_spec;
+
+// Produces `len` strictly increasing event end times in (0, period * len]
+// together with event durations. Every process has a mean inter-arrival gap
+// of `period` ticks, so the stream always spans the same query interval as the
+// periodic baseline regardless of the chosen process.
+class ArrivalGen {
+public:
+    ArrivalGen(const ArrivalSpec& spec, dur_t period, int64_t len) :
+        spec(spec), period(period), len(len), end(period * len), rng(spec.seed)
+    {
+        if (spec.process == "trace") {
+            load_trace();
+        }
+    }
+
+    ival_t next()
+    {
+        ts_t t = 0;
+        if (spec.process == "periodic") {
+            t = period * (k + 1);
+        } else if (spec.process == "jitter") {
+            uniform_real_distribution<double> shift(-spec.jitter / 2, spec.jitter / 2);
+            t = period * (k + 1) + llround(shift(rng) * period);
+        } else if (spec.process == "poisson") {
+            // sorted uniforms generated in order, i.e. a Poisson process
+            // conditioned on exactly `len` arrivals in (0, end]
+            uniform_real_distribution<double> u(0, 1);
+            pos += (1 - pos) * (1 - pow(u(rng), 1.0 / (len - k)));
+            t = static_cast<ts_t>(ceil(pos * end));
+        } else if (spec.process == "onoff") {
+            t = last + next_onoff_gap();
+        } else if (spec.process == "trace") {
+            t = last + llround(gaps[k % gaps.size()] * trace_scale);
+        }
+
+        // keep times strictly increasing and leave room for the remaining events
+        t = max(t, last + 1);
+        t = min(t, end - (len - k - 1));
+
+        auto gap = t - last;
+        dur_t d = gap;
+        if (spec.duration == "fixed") {
+            d = llround(spec.dur_ticks);
+        } else if (spec.duration == "exp") {
+            exponential_distribution<double> exp_dur(1.0 / spec.dur_ticks);
+            d = llround(exp_dur(rng));
+        }
+        d = max(min(d, gap), (dur_t) 1);
+
+        last = t;
+        k++;
+        return ival_t{t, d};
+    }
+
+private:
+    dur_t next_onoff_gap()
+    {
+        // bursts of geometric length with events every duty * period ticks,
+        // separated by exponential silences that restore the mean rate
+        double on_gap = spec.duty * period;
+        if (burst_left == 0) {
+            geometric_distribution<int64_t> burst(1.0 / spec.burst_events);
+            burst_left = burst(rng) + 1;
+            exponential_distribution<double> off(1.0 / (spec.burst_events * period * (1 - spec.duty)));
+            burst_left--;
+            return llround(on_gap + off(rng));
+        }
+        burst_left--;
+        return llround(on_gap);
+    }
+
+    void load_trace()
+    {
+        ifstream f(spec.trace);
+        if (!f) {
+            throw runtime_error("Cannot open trace " + spec.trace);
+        }
+        double gap, sum = 0;
+        while (f >> gap) {
+            gaps.push_back(gap);
+            sum += gap;
+        }
+        if (gaps.empty() || sum <= 0) {
+            throw runtime_error("Empty trace " + spec.trace);
+        }
+        trace_scale = period / (sum / gaps.size());
+    }
+
+    ArrivalSpec spec;
+    dur_t period;
+    int64_t len;
+    ts_t end;
+    mt19937_64 rng;
+
+    int64_t k = 0;
+    ts_t last = 0;
+    double pos = 0;
+    int64_t burst_left = 0;
+    vector<double> gaps;
+    double trace_scale = 1;
+};
+
+// Delivers the events of an ArrivalGen out of order: each event is held back
+// by a random delay of up to `spec.disorder` ticks and released in order of
+// t + delay. An event is therefore never overtaken by one more than
+// `spec.disorder` ticks younger than itself.
+template<typename T>
+class DisorderedArrivals {
+public:
+    struct Event {
+        ts_t t;
+        dur_t d;
+        T payload;
+        ts_t arrival;
+
+        bool operator>(const Event& o) const { return arrival > o.arrival; }
+    };
+
+    DisorderedArrivals(const ArrivalSpec& spec, dur_t period, int64_t len, function<T(int64_t)> payload) :
+        gen(spec, period, len), len(len), bound(spec.disorder), payload(payload), rng(spec.seed + 1)
+    {}
+
+    bool next(Event& e)
+    {
+        uniform_int_distribution<dur_t> delay(0, bound);
+        // pull until the earliest pending arrival is older than anything still to be generated
+        while (k < len && (held.empty() || held.top().arrival > last)) {
+            auto iv = gen.next();
+            last = iv.t;
+            held.push(Event{iv.t, iv.d, payload(k), iv.t + delay(rng)});
+            k++;
+        }
+        if (held.empty()) {
+            return false;
+        }
+        e = held.top();
+        held.pop();
+        return true;
+    }
+
+private:
+    ArrivalGen gen;
+    int64_t len;
+    dur_t bound;
+    function<T(int64_t)> payload;
+    mt19937_64 rng;
+
+    int64_t k = 0;
+    ts_t last = 0;
+    priority_queue<Event, vector<Event>, greater<Event>> held;
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_ARRIVAL_H_
@@ -24,7 +24,7 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         float osize = (float)size / (float)w;
         out_reg = create_reg<float>(ceil(osize));
 
@@ -38,6 +38,13 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        auto ref = ref_window<float, pair<float, float>>(&in_reg, w, period * size, {0, 0},
+            [](pair<float, float> s, float v) { return make_pair(s.first + v, s.second + 1); });
+        return ref_compare(&out_reg, ref_map(ref, [](pair<float, float> s) { return s.first / s.second; }));
+    }
+
     void release() final
     {
 #ifdef _PRINT_REGION_
@@ -82,7 +89,7 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         float osize = (float)size / (float)w;
         out_reg = create_reg<float>(ceil(osize));
 
@@ -96,6 +103,13 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        auto ref = ref_window<float, pair<float, float>>(&in_reg, w, period * size, {0, 0},
+            [](pair<float, float> s, float v) { return make_pair(s.first + v, s.second + 1); });
+        return ref_compare(&out_reg, ref_map(ref, [](pair<float, float> s) { return s.first / s.second; }));
+    }
+
     void release() final
     {
 #ifdef _PRINT_REGION_
@@ -2,10 +2,38 @@
 #define TILT_BENCH_INCLUDE_TILT_BASE_H_
 
 #include "tilt/builder/tilder.h"
+#include "tilt_cse.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
 
+// TiLT type and constant builder of a C++ payload type
+template<typename T> struct TiltType;
+template<> struct TiltType<int8_t> {
+    static DataType type() { return types::INT8; }
+    static Expr val(int8_t v) { return _i8(v); }
+};
+template<> struct TiltType<int16_t> {
+    static DataType type() { return types::INT16; }
+    static Expr val(int16_t v) { return _i16(v); }
+};
+template<> struct TiltType<int32_t> {
+    static DataType type() { return types::INT32; }
+    static Expr val(int32_t v) { return _i32(v); }
+};
+template<> struct TiltType<int64_t> {
+    static DataType type() { return types::INT64; }
+    static Expr val(int64_t v) { return _i64(v); }
+};
+template<> struct TiltType<float> {
+    static DataType type() { return types::FLOAT32; }
+    static Expr val(float v) { return _f32(v); }
+};
+template<> struct TiltType<double> {
+    static DataType type() { return types::FLOAT64; }
+    static Expr val(double v) { return _f64(v); }
+};
+
 Op _Select(_sym in, _sym val, function<Expr(_sym, _sym)> selector)
 {
     auto e = in[_pt(0)];
@@ -54,13 +82,13 @@ Op _Where(_sym in, function<Expr(_sym)> filter)
 Expr _Count(_sym win)
 {
     auto acc = [](Expr s, Expr st, Expr et, Expr d) { return _add(s, _f32(1)); };
-    return _red(win, _f32(0), acc);
+    return cse_key(_red(win, _f32(0), acc), "count(" + cse_id(win) + ")");
 }
 
 Expr _Sum(_sym win)
 {
     auto acc = [](Expr s, Expr st, Expr et, Expr d) { return _add(s, d); };
-    return _red(win, _f32(0), acc);
+    return cse_key(_red(win, _f32(0), acc), "sum(" + cse_id(win) + ")");
 }
 
 Op _WindowSum(_sym in, int64_t w, int64_t p)
@@ -75,7 +103,7 @@ Op _WindowSum(_sym in, int64_t w, int64_t p)
         SymTable{ {window_sym, window}, {sum_sym, sum} },
         _true(),
         sum_sym);
-    return wc_op;
+    return cse_key(wc_op, "wsum(" + cse_id(in) + "," + to_string(w) + "," + to_string(p) + ")");
 }
 
 Op _WindowSum(_sym in, int64_t w)
@@ -86,7 +114,7 @@ Op _WindowSum(_sym in, int64_t w)
 Expr _Sum64(_sym win)
 {
     auto acc = [](Expr s, Expr st, Expr et, Expr d) { return _add(s, d); };
-    return _red(win, _i64(0), acc);
+    return cse_key(_red(win, _i64(0), acc), "sum64(" + cse_id(win) + ")");
 }
 
 Op _WindowSum64(_sym in, int64_t w, int64_t p)
@@ -101,7 +129,7 @@ Op _WindowSum64(_sym in, int64_t w, int64_t p)
         SymTable{ {window_sym, window}, {sum_sym, sum} },
         _true(),
         sum_sym);
-    return wc_op;
+    return cse_key(wc_op, "wsum64(" + cse_id(in) + "," + to_string(w) + "," + to_string(p) + ")");
 }
 
 Op _WindowSum64(_sym in, int64_t w)
@@ -112,7 +140,7 @@ Op _WindowSum64(_sym in, int64_t w)
 Expr _Sum8(_sym win)
 {
     auto acc = [](Expr s, Expr st, Expr et, Expr d) { return _add(s, d); };
-    return _red(win, _i8(0), acc);
+    return cse_key(_red(win, _i8(0), acc), "sum8(" + cse_id(win) + ")");
 }
 
 Op _WindowSum8(_sym in, int64_t w, int64_t p)
@@ -127,7 +155,7 @@ Op _WindowSum8(_sym in, int64_t w, int64_t p)
         SymTable{ {window_sym, window}, {sum_sym, sum} },
         _true(),
         sum_sym);
-    return wc_op;
+    return cse_key(wc_op, "wsum8(" + cse_id(in) + "," + to_string(w) + "," + to_string(p) + ")");
 }
 
 Op _WindowSum8(_sym in, int64_t w)
@@ -151,7 +179,7 @@ Op _WindowAvg(_sym in, int64_t w)
         SymTable{ {window_sym, window}, {count_sym, count}, {sum_sym, sum}, {avg_sym, avg} },
         _true(),
         avg_sym);
-    return wc_op;
+    return cse_key(wc_op, "wavg(" + cse_id(in) + "," + to_string(w) + ")");
 }
 
 Expr _Average(_sym win, function<Expr(Expr)> selector)
@@ -178,7 +206,7 @@ Op _WindowAvgOnePass(_sym in, int64_t w)
         SymTable{ {window_sym, window}, {avg_state_sym, avg_state}, {avg_sym, avg} },
         _true(),
         avg_sym);
-    return wc_op;
+    return cse_key(wc_op, "wavg1p(" + cse_id(in) + "," + to_string(w) + ")");
 }
 
 Expr _Var64OnePass(_sym win)
@@ -192,7 +220,7 @@ Expr _Var64OnePass(_sym win)
                                  _add(count, _i64(1))});
     };
 
-    return _red(win, _new(vector<Expr>{_i64(0), _i64(0), _i64(0)}), acc);
+    return cse_key(_red(win, _new(vector<Expr>{_i64(0), _i64(0), _i64(0)}), acc), "var64(" + cse_id(win) + ")");
 }
 
 Op _WindowVar64OnePass(_sym in, int64_t window)
@@ -235,7 +263,7 @@ Op _WindowVar64OnePass(_sym in, int64_t window)
         },
         _true(),
         var_sym);
-    return wc_op;
+    return cse_key(wc_op, "wvar64(" + cse_id(in) + "," + to_string(window) + ")");
 }
 
 Op _Join(_sym left, _sym right, function<Expr(_sym, _sym)> op)
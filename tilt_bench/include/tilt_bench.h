@@ -1,11 +1,18 @@
 #ifndef TILT_BENCH_INCLUDE_TILT_BENCH_H_
 #define TILT_BENCH_INCLUDE_TILT_BENCH_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <memory>
 #include <cstdlib>
 #include <chrono>
 #include <thread>
 #include <fstream>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unordered_map>
 
 #include "tilt/codegen/loopgen.h"
 #include "tilt/codegen/llvmgen.h"
@@ -13,6 +20,17 @@
 #include "tilt/engine/engine.h"
 #include "tilt/codegen/printer.h"
 
+#include "tilt_arrival.h"
+#include "tilt_sink.h"
+#include "tilt_reference.h"
+#include "tilt_latency.h"
+#include "tilt_pool.h"
+#include "tilt_cse.h"
+#include "tilt_tier.h"
+#include "tilt_interp.h"
+#include "tilt_aot.h"
+#include "tilt_profile.h"
+
 using namespace std;
 using namespace std::chrono;
 using namespace tilt;
@@ -27,7 +45,16 @@ public:
 template<typename T>
 class SynthData : public Dataset<T> {
 public:
-    SynthData(dur_t period, int64_t len) : period(period), len(len) {}
+    // `missing` is the fraction of the `len` slots left empty and `burst` the
+    // mean length of a run of empty slots (two-state Gilbert model). Rates
+    // above 1/2 need runs longer than one slot, so `burst` is raised if needed.
+    SynthData(dur_t period, int64_t len, double missing = 0, int64_t burst = 1) :
+        period(period), len(len), missing(missing),
+        burst(max(burst, static_cast<int64_t>(ceil(missing / (1 - missing)))))
+    {
+        ASSERT(missing >= 0 && missing < 1);
+        ASSERT(burst >= 1);
+    }
 
     void fill(region_t* reg) final
     {
@@ -36,12 +63,29 @@ public:
         int delta_range = 100;
         T base;
 
+        double enter_gap = missing / (burst * (1 - missing));
+        double leave_gap = 1.0 / burst;
+        bool in_gap = false;
+
+        ArrivalGen arrivals(arrival_spec, period, len);
+
         auto data = reinterpret_cast<T*>(reg->data);
         for (int i = 0; i < len; i++) {
             if(i % 64 == 0){
                 base = static_cast<T>(rand() / static_cast<double>(RAND_MAX / base_range)) + min_base;
             }
-            auto t = period * (i + 1);
+            auto iv = arrivals.next();
+            auto t = iv.t;
+            if (missing > 0) {
+                auto coin = rand() / static_cast<double>(RAND_MAX);
+                in_gap = in_gap ? (coin >= leave_gap) : (coin < enter_gap);
+                if (in_gap) {
+                    continue;
+                }
+            }
+            if (get_end_time(reg) < t - iv.d) {
+                commit_null(reg, t - iv.d);
+            }
             commit_data(reg, t);
             auto delta = static_cast<T>(rand() % delta_range);
             auto* ptr = reinterpret_cast<T*>(fetch(reg, t, get_end_idx(reg), sizeof(T)));
@@ -52,6 +96,8 @@ public:
 private:
     dur_t period;
     int64_t len;
+    double missing;
+    int64_t burst;
 };
 
 struct Yahoo {
@@ -67,6 +113,48 @@ struct Yahoo {
     Yahoo() {}
 };
 
+// Yahoo record with every column dictionary encoded to one byte
+struct YahooCode {
+    int8_t user_id;
+    int8_t camp_id;
+    int8_t event_type;
+    int8_t padding;
+};
+
+// Dictionary of a low-cardinality column, codes are handed out in order of
+// first appearance. The largest code is reserved for values not in the
+// dictionary, so predicates on such values match nothing.
+template<typename T, typename C>
+class Dictionary {
+public:
+    C encode(T v)
+    {
+        auto it = codes.find(v);
+        if (it != codes.end()) {
+            return it->second;
+        }
+        if (values.size() >= numeric_limits<C>::max()) {
+            throw runtime_error("Dictionary overflow");
+        }
+        C c = values.size();
+        codes[v] = c;
+        values.push_back(v);
+        return c;
+    }
+
+    C code(T v) const
+    {
+        auto it = codes.find(v);
+        return (it != codes.end()) ? it->second : numeric_limits<C>::max();
+    }
+
+    T decode(C c) const { return values[c]; }
+
+private:
+    unordered_map<T, C> codes;
+    vector<T> values;
+};
+
 class YahooData : public Dataset<Yahoo> {
 public:
     YahooData(dur_t period, int64_t len) : period(period), len(len) {}
@@ -75,9 +163,15 @@ public:
     {
         double range = 100;
 
+        ArrivalGen arrivals(arrival_spec, period, len);
+
         auto data = reinterpret_cast<Yahoo*>(reg->data);
         for (int i = 0; i < len; i++) {
-            auto t = period * (i + 1);
+            auto iv = arrivals.next();
+            auto t = iv.t;
+            if (get_end_time(reg) < t - iv.d) {
+                commit_null(reg, t - iv.d);
+            }
             commit_data(reg, t);
             auto* ptr = reinterpret_cast<Yahoo*>(fetch(reg, t, get_end_idx(reg), sizeof(Yahoo)));
             *ptr = Yahoo(rand() % 5 + 1, rand() % 5 + 1, rand() % 5 + 1);
@@ -92,13 +186,48 @@ private:
 
 class Benchmark {
 public:
+    virtual ~Benchmark() {}
+
     virtual void init() = 0;
     virtual void release() = 0;
 
-    intptr_t compile()
+    virtual intptr_t compile()
     {
-        auto query_op = query();
-        auto query_op_sym = _sym("query", query_op);
+        return compile_op(query(), "query");
+    }
+
+    // Code with the signature and output of the compiled query, run while it
+    // compiles in tiered mode: the interpreter of query() unless the benchmark
+    // has a native baseline, and 0 for native kernels, which do not compile
+    virtual intptr_t tier0() { return native() ? 0 : interp_compile(query()); }
+
+    // Whether compile() hands out a native kernel rather than generated code.
+    // A kernel may set itself up in compile(), so it is never reused by code
+    // key and every run calls compile() again, which costs nothing.
+    virtual bool native() { return false; }
+
+    // Whether run_query may split the query into concurrent time partitions
+    // with --intra. Only queries keeping no state between invocations besides
+    // the input they read back opt in: a recursive Aux state region would be
+    // shared by all partitions, each starting from the wrong state.
+    virtual bool partitionable() { return false; }
+
+    // JIT compiles `query_op` into a function named after `name`. A process
+    // may compile many queries, so every function gets a numbered name. With
+    // --aot the query comes from a shared object instead.
+    static intptr_t compile_op(Op query_op, string name)
+    {
+        static int compiled = 0;
+        auto start = high_resolution_clock::now();
+        if (cse_enabled) {
+            cse(query_op);
+        }
+        if (!aot_dir.empty()) {
+            auto addr = aot_compile(query_op);
+            compile_stats.us += duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+            return addr;
+        }
+        auto query_op_sym = _sym(name + "_" + to_string(compiled++), query_op);
 
         auto loop = LoopGen::Build(query_op_sym, query_op.get());
 
@@ -108,6 +237,8 @@ public:
         jit->AddModule(move(llmod));
         auto addr = jit->Lookup(loop->get_name());
 
+        compile_stats.jit++;
+        compile_stats.us += duration_cast<microseconds>(high_resolution_clock::now() - start).count();
         return addr;
     }
 
@@ -121,7 +252,11 @@ public:
         execute(addr);
         auto end_time = high_resolution_clock::now();
 
+        if (verify_output) {
+            verdict = verify();
+        }
         release();
+        release_part_regs();
 
         return duration_cast<microseconds>(end_time - start_time).count();
     }
@@ -137,12 +272,72 @@ public:
         return reg;
     }
 
+    // Region of `size` events on the timeline of the datasets: an input they
+    // fill, or an output passing its events through. A short --duration puts
+    // a null entry in front of every event.
+    template<typename T>
+    static region_t create_in_reg(int64_t size)
+    {
+        return create_reg<T>(size * arrival_spec.entries_per_event());
+    }
+
     static void release_reg(region_t* reg)
     {
         delete [] reg->tl;
         delete [] reg->data;
     }
 
+    // A region holding f(entry) for every entry of `reg` and sharing its
+    // timeline. Only the payload is owned, so the timeline must outlive it and
+    // the region is freed by release_col.
+    template<typename T, typename U, typename F>
+    static region_t map_reg(region_t* reg, F f)
+    {
+        auto col = *reg;
+        auto rows = reinterpret_cast<T*>(reg->data);
+        auto data = new U[reg->mask + 1];
+        for (idx_t i = get_start_idx(reg); i <= get_end_idx(reg); i++) {
+            data[i & reg->mask] = f(rows[i & reg->mask]);
+        }
+        col.data = reinterpret_cast<char*>(data);
+        return col;
+    }
+
+    // Columnar layout of a STRUCT region: one field of every entry
+    template<typename T, typename F>
+    static region_t column_reg(region_t* reg, F T::*field)
+    {
+        return map_reg<T, F>(reg, [field](const T& row) { return row.*field; });
+    }
+
+    static void release_col(region_t* reg)
+    {
+        delete [] reg->data;
+    }
+
+    // Drops the entries ending by `t` from the front of a region that is
+    // read as a sliding window, releasing their slots
+    static void trim_reg(region_t* reg, ts_t t)
+    {
+        auto si = get_start_idx(reg);
+        while (si < get_end_idx(reg)) {
+            auto iv = reg->tl[(si + 1) & reg->mask];
+            if (iv.t + iv.d > t) {
+                break;
+            }
+            si++;
+        }
+        reg->si = si;
+        reg->st = reg->tl[si & reg->mask].t + reg->tl[si & reg->mask].d;
+    }
+
+    // bytes held by the committed entries of a region, timeline included
+    template<typename T>
+    static int64_t reg_bytes(region_t* reg)
+    {
+        return (get_end_idx(reg) - get_start_idx(reg) + 1) * (sizeof(ival_t) + sizeof(T));
+    }
+
 #ifdef _PRINT_REGION_
     template<typename T>
     void print_reg(region_t* reg, string fname)
@@ -167,6 +362,9 @@ public:
     void print_loopIR( string fname )
     {
         auto query_op = query();
+        if (cse_enabled) {
+            cse(query_op);
+        }
         auto query_op_sym = _sym("query", query_op);
 
         auto loop = LoopGen::Build(query_op_sym, query_op.get());
@@ -180,6 +378,9 @@ public:
     void print_llvmIR( string fname )
     {
         auto query_op = query();
+        if (cse_enabled) {
+            cse(query_op);
+        }
         auto query_op_sym = _sym("query", query_op);
 
         auto loop = LoopGen::Build(query_op_sym, query_op.get());
@@ -196,22 +397,332 @@ public:
 
     virtual Op query() = 0;
     virtual void execute(intptr_t) = 0;
+
+    // Compares the output of execute() with a scalar reference implementation
+    // from tilt_reference.h. Benchmarks without one leave it unchecked.
+    virtual Verdict verify() { return Verdict(); }
+
+    // Input events per query invocation: a micro-batch when running with
+    // --batch, otherwise a sink slice
+    static int64_t slice_events()
+    {
+        return (micro_batch > 0) ? micro_batch : sink_spec.chunk;
+    }
+
+    // Output region of a query writing at most `size` events over `len` input
+    // events, which may be passed through with their null entries. With a
+    // draining sink this is a ring holding a few slices only.
+    template<typename T>
+    region_t create_out_reg(int64_t size, int64_t len)
+    {
+        sink.open(sizeof(T), to_string(part));
+        out_width = sizeof(T);
+        if (sink_spec.mode == SinkMode::FULL) {
+            auto reg = create_in_reg<T>(size);
+            if (intra_threads > 1) {
+                create_part_regs(reg.mask + 1);
+            }
+            return reg;
+        }
+        auto slice = (size * slice_events() + len - 1) / len;
+        return create_in_reg<T>(4 * slice + 16);
+    }
+
+    // Runs the query at `addr` over (0, end] of an input of `len` events. With
+    // a draining sink or in micro-batch mode the query runs in slices of
+    // slice_events() events, rounded up to a multiple of `align` ticks. Every
+    // slice of output is handed to the sink while the ring is at most half
+    // full, and in micro-batch mode the time of every invocation is recorded.
+    template<typename... Regs>
+    void run_query(intptr_t addr, ts_t end, int64_t len, dur_t align, region_t* out, Regs*... ins)
+    {
+        typedef region_t* (*QueryFn)(ts_t, ts_t, region_t*, Regs*...);
+        auto query = (QueryFn) addr;
+        if (intra_threads > 1) {
+            if (!partitionable()) {
+                throw runtime_error("--intra needs a query without recursive state");
+            }
+            run_partitioned(query, end, align, out, ins...);
+            return;
+        }
+        bool record = (tier_mode != TierMode::OFF);
+        if (sink_spec.mode == SinkMode::FULL && micro_batch == 0 && !record) {
+            query(0, end, out, ins...);
+            return;
+        }
+
+        auto step = max<ts_t>(end * slice_events() / len, 1);
+        step = ((step + align - 1) / align) * align;
+        batch_events = (step * len + end - 1) / end;
+        auto half = (out->mask + 1) / 2;
+        bool drain = (sink_spec.mode != SinkMode::FULL);
+
+        auto run_start = steady_clock::now();
+        bool compiled = (hot_addr == nullptr);
+        auto timed_query = [&](ts_t t_start, ts_t t_end) {
+            // switch to the compiled code once it is ready
+            if (!compiled && hot_addr->load(memory_order_acquire) != 0) {
+                query = (QueryFn) hot_addr->load(memory_order_relaxed);
+                compiled = true;
+            }
+            auto from = get_end_idx(out);
+            auto start_time = steady_clock::now();
+            query(t_start, t_end, out, ins...);
+            auto end_time = steady_clock::now();
+            if (micro_batch > 0) {
+                latency.record(duration_cast<nanoseconds>(end_time - start_time).count());
+            }
+            if (record) {
+                auto us = duration_cast<microseconds>(end_time - run_start).count();
+                if (first_result_us < 0 && get_end_idx(out) > from) {
+                    first_result_us = us;
+                }
+                tier_samples.push_back(TierSample{us, (t_end * len + end - 1) / end, compiled});
+            }
+        };
+
+        if (!drain || !sink_spec.thread) {
+            for (ts_t t = 0; t < end; t += step) {
+                auto from = get_end_idx(out);
+                timed_query(t, min(t + step, end));
+                if (drain) {
+                    if (get_end_idx(out) - from > half) {
+                        throw runtime_error("Sink ring overflow");
+                    }
+                    sink.consume(out, from, get_end_idx(out));
+                }
+            }
+            sink.close();
+            return;
+        }
+
+        atomic<idx_t> produced(get_end_idx(out));
+        atomic<idx_t> consumed(get_end_idx(out));
+        atomic<bool> done(false);
+        thread consumer([&]() {
+            idx_t seen = consumed.load();
+            while (true) {
+                auto fin = done.load(memory_order_acquire);
+                auto p = produced.load(memory_order_acquire);
+                if (p > seen) {
+                    sink.consume(out, seen, p);
+                    seen = p;
+                    consumed.store(seen, memory_order_release);
+                } else if (fin) {
+                    break;
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+
+        bool overflow = false;
+        for (ts_t t = 0; t < end && !overflow; t += step) {
+            auto from = get_end_idx(out);
+            while (from - consumed.load(memory_order_acquire) > half) {
+                this_thread::yield();
+            }
+            timed_query(t, min(t + step, end));
+            overflow = get_end_idx(out) - from > half;
+            produced.store(get_end_idx(out), memory_order_release);
+        }
+        done.store(true, memory_order_release);
+        consumer.join();
+        sink.close();
+
+        if (overflow) {
+            throw runtime_error("Sink ring overflow");
+        }
+    }
+
+    // Output regions of the partitions of run_partitioned, four per thread of
+    // the task pool, each holding twice a fair share of an output of
+    // `out_size` entries. Allocated with the output region, so run_partitioned
+    // only resets them.
+    void create_part_regs(int64_t out_size)
+    {
+        release_part_regs();
+        int64_t parts = 4 * TaskPool::Get()->size();
+        auto cap = get_buf_size(2 * out_size / parts + 64);
+        part_regs.resize(parts);
+        for (auto& reg : part_regs) {
+            init_region(&reg, 0, cap, new ival_t[cap], new char[cap * out_width]);
+        }
+    }
+
+    void release_part_regs()
+    {
+        for (auto& reg : part_regs) {
+            release_reg(&reg);
+        }
+        part_regs.clear();
+    }
+
+    // Runs the query over (0, end] as one invocation split into the time
+    // partitions of part_regs, of a multiple of `align` ticks. Every partition
+    // writes to its own region, reset to start at its start time, so the
+    // partitions only share the input, which they read back as far as the
+    // query looks. The partitions are then appended to `out` in order, a null
+    // marking a gap between two of them.
+    template<typename... Regs>
+    void run_partitioned(region_t* (*query)(ts_t, ts_t, region_t*, Regs*...), ts_t end, dur_t align,
+        region_t* out, Regs*... ins)
+    {
+        if (sink_spec.mode != SinkMode::FULL || micro_batch > 0) {
+            throw runtime_error("--intra needs the full output region and no --batch");
+        }
+        if (part_regs.empty()) {
+            throw runtime_error("--intra needs an output region made by create_out_reg");
+        }
+        auto pool = TaskPool::Get();
+        int64_t parts = part_regs.size();
+        vector<ts_t> bounds(parts + 1);
+        for (int64_t k = 0; k < parts; k++) {
+            bounds[k] = min(end, ((end * k / parts + align - 1) / align) * align);
+        }
+        bounds[parts] = end;
+
+        auto& regs = part_regs;
+        atomic<bool> overflow(false);
+        pool->parallel_for(parts, [&](int64_t k) {
+            init_region(&regs[k], bounds[k], regs[k].mask + 1, regs[k].tl, regs[k].data);
+            if (bounds[k] < bounds[k + 1]) {
+                query(bounds[k], bounds[k + 1], &regs[k], ins...);
+            }
+            if (get_end_idx(&regs[k]) - get_start_idx(&regs[k]) > regs[k].mask) {
+                overflow = true;
+            }
+        });
+        if (overflow) {
+            throw runtime_error("Partition output overflow");
+        }
+
+        // position of every partition in `out`, with its start marker when
+        // the output before it ends earlier
+        vector<idx_t> pos(parts + 1);
+        vector<bool> marker(parts);
+        pos[0] = get_end_idx(out);
+        auto last = get_end_time(out);
+        for (int64_t k = 0; k < parts; k++) {
+            marker[k] = last < bounds[k];
+            pos[k + 1] = pos[k] + marker[k] + get_end_idx(&regs[k]) - get_start_idx(&regs[k]);
+            last = (get_end_idx(&regs[k]) > get_start_idx(&regs[k])) ? get_end_time(&regs[k]) : max(last, bounds[k]);
+        }
+        if (pos[parts] - get_start_idx(out) > out->mask) {
+            throw runtime_error("Output region overflow");
+        }
+
+        pool->parallel_for(parts, [&](int64_t k) {
+            auto reg = &regs[k];
+            auto from = get_start_idx(reg) + !marker[k];
+            for (auto i = from, o = pos[k] + 1; i <= get_end_idx(reg);) {
+                // copy the longest run contiguous in both rings
+                auto si = i & reg->mask;
+                auto oi = o & out->mask;
+                auto n = min({get_end_idx(reg) - i + 1, reg->mask + 1 - si, out->mask + 1 - oi});
+                memcpy(out->tl + oi, reg->tl + si, n * sizeof(ival_t));
+                memcpy(out->data + oi * out_width, reg->data + si * out_width, n * out_width);
+                i += n;
+                o += n;
+            }
+        });
+        out->ei = pos[parts];
+    }
+
+    // payload bytes of the output region made by create_out_reg
+    int64_t out_width = 0;
+
+    // regions of the partitions of run_partitioned, made by create_out_reg
+    vector<region_t> part_regs;
+
+    // compiled code published by ParallelBenchmark in tiered mode while the
+    // benchmark runs tier0(), null otherwise
+    atomic<intptr_t>* hot_addr = nullptr;
+
+    // slices recorded in tiered and jit mode, and the time of the first one
+    // producing output
+    vector<TierSample> tier_samples;
+    int64_t first_result_us = -1;
+
+    // counters of the operators of the query, filled by benchmarks running
+    // them one by one in a -DPROFILE_OPS=ON build
+    vector<OpCounters> op_counters;
+
+    // input footprint read by the query, set in init() by benchmarks that report it
+    int64_t input_bytes = 0;
+
+    // receives the output when run_query drains it, and the partition it belongs to
+    Sink sink;
+    int part = 0;
+
+    // result of verify() when running with --verify
+    Verdict verdict;
+
+    // per micro-batch processing time in ns, and the batch size actually run
+    // after rounding to the query's alignment
+    LatencyHistogram latency;
+    int64_t batch_events = 0;
 };
 
+// Compiled queries by code key, reused by later runs in the same process
+inline map<string, intptr_t> compiled_queries;
+
 class ParallelBenchmark {
 public:
+    virtual ~ParallelBenchmark()
+    {
+        for (auto bench : benchs) {
+            delete bench;
+        }
+    }
+
     int64_t run()
     {
-        auto addr = benchs[0]->compile();
+        // in tiered mode the benchmarks start on tier0() and the query
+        // compiles in the background once the inputs are ready
+        auto compile_start = high_resolution_clock::now();
+        intptr_t addr = 0;
+        bool background = false;
+        bool cached = !code_key.empty() && !benchs[0]->native();
+        if (cached && compiled_queries.count(code_key)) {
+            addr = compiled_queries[code_key];
+            reused = true;
+        } else if (tier_mode == TierMode::TIERED && (addr = benchs[0]->tier0()) != 0) {
+            background = true;
+        } else {
+            addr = benchs[0]->compile();
+            if (cached) {
+                compiled_queries[code_key] = addr;
+            }
+        }
+        compile_us = duration_cast<microseconds>(high_resolution_clock::now() - compile_start).count();
+        compile_wait_us = compile_us;
 
         for (int i = 0; i < benchs.size(); i++) {
+            benchs[i]->part = i;
             benchs[i]->init();
         }
 
+        atomic<intptr_t> hot(0);
+        thread jit;
+        if (background) {
+            compile_wait_us = 0;
+            jit = thread([this, &hot, cached]() {
+                auto jit_start = high_resolution_clock::now();
+                auto jit_addr = benchs[0]->compile();
+                compile_us = duration_cast<microseconds>(high_resolution_clock::now() - jit_start).count();
+                if (cached) {
+                    compiled_queries[code_key] = jit_addr;
+                }
+                hot.store(jit_addr, memory_order_release);
+            });
+        }
+
         vector<thread> splits;
         auto start_time = high_resolution_clock::now();
         for (int i = 0; i < benchs.size(); i++) {
             auto bench = benchs[i];
+            bench->hot_addr = background ? &hot : nullptr;
             splits.push_back(thread([bench, addr]() {
                 bench->execute(addr);
             }));
@@ -220,15 +731,112 @@ public:
             splits[i].join();
         }
         auto end_time = high_resolution_clock::now();
+        if (background) {
+            jit.join();
+        }
 
         for (int i = 0; i < benchs.size(); i++) {
+            benchs[i]->hot_addr = nullptr;
+            if (verify_output) {
+                benchs[i]->verdict = benchs[i]->verify();
+            }
             benchs[i]->release();
+            benchs[i]->release_part_regs();
         }
 
         return duration_cast<microseconds>(end_time - start_time).count();
     }
 
+    // counters of every operator summed over the partitions
+    vector<OpCounters> op_profile()
+    {
+        vector<OpCounters> res;
+        for (auto bench : benchs) {
+            merge_profile(res, bench->op_counters);
+        }
+        return res;
+    }
+
+    TierStats tier_stats()
+    {
+        TierStats res;
+        res.compile_us = compile_us;
+        for (auto bench : benchs) {
+            auto first = bench->first_result_us;
+            if (first >= 0 && (res.first_result_us < 0 || compile_wait_us + first < res.first_result_us)) {
+                res.first_result_us = compile_wait_us + first;
+            }
+        }
+        res.samples = benchs[0]->tier_samples;
+        for (auto& s : res.samples) {
+            if (s.compiled) {
+                res.switch_us = compile_wait_us + s.us;
+                break;
+            }
+        }
+        return res;
+    }
+
+    int64_t input_bytes()
+    {
+        int64_t bytes = 0;
+        for (auto bench : benchs) {
+            bytes += bench->input_bytes;
+        }
+        return bytes;
+    }
+
+    int64_t sink_count()
+    {
+        int64_t count = 0;
+        for (auto bench : benchs) {
+            count += bench->sink.count;
+        }
+        return count;
+    }
+
+    uint64_t sink_checksum()
+    {
+        uint64_t checksum = 0;
+        for (auto bench : benchs) {
+            checksum += bench->sink.checksum;
+        }
+        return checksum;
+    }
+
+    LatencyHistogram latency()
+    {
+        LatencyHistogram res;
+        for (auto bench : benchs) {
+            res.merge(bench->latency);
+        }
+        return res;
+    }
+
+    int64_t batch_events() { return benchs[0]->batch_events; }
+
+    Verdict verdict()
+    {
+        Verdict res;
+        res.checked = true;
+        res.checksum = 0;
+        for (auto bench : benchs) {
+            res.checked &= bench->verdict.checked;
+            res.entries += bench->verdict.entries;
+            res.mismatches += bench->verdict.mismatches;
+            res.checksum += bench->verdict.checksum;
+        }
+        return res;
+    }
+
     vector<Benchmark*> benchs;
+
+    // identifies the generated code of the query, empty to always compile
+    string code_key;
+    bool reused = false;
+    int64_t compile_us = 0;
+    // part of compile_us the benchmarks waited for before they started
+    int64_t compile_wait_us = 0;
 };
 
 #endif  // TILT_BENCH_INCLUDE_TILT_BENCH_H_
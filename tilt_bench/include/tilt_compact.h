@@ -0,0 +1,668 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_COMPACT_H_
+#define TILT_BENCH_INCLUDE_TILT_COMPACT_H_
+
+#include <immintrin.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+#include "tilt_width.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Filter with compress-store of payloads and timelines.
+ *
+ * The generated code of _Where walks the input one event at a time and
+ * branches on the predicate before committing to the output, which costs a
+ * misprediction per event at selectivities away from 0 and 1. These native
+ * kernels evaluate the predicate for 64 events at once into a bitmask and
+ * write the kept events without branching. Every kept event whose
+ * predecessor was dropped is preceded by a null, so each event maps to the
+ * interleaved lanes (null, data) and the output is the compressed lane
+ * sequence. The AVX-512 kernel stores the lanes with vpcompress, the AVX2
+ * kernel writes them through a shuffle table of lane indices. The kernel is
+ * picked at runtime by CPU feature, or forced with --simd. The output is the
+ * region the TiLT query commits, so --verify and the sinks apply unchanged.
+ *
+ * No single kernel wins at every selectivity: near 0 and 1 the branch of the
+ * scalar kernel is predictable and cheaper than building masks, in between
+ * the branch-free kernels are. The adaptive kernel samples the predicate over
+ * every block of the input and runs the block on the kernel suited to its
+ * selectivity, switching again when the selectivity of the stream moves. */
+
+// Kernel of the compact where benchmarks, set once from the main.cpp flag
+// --where_kernel=<compress|branch|predicated|adaptive>. compress is the
+// kernel picked by --simd.
+inline string where_kernel = "compress";
+
+// Selectivities of consecutive equal phases of the compact where input, set
+// once from the main.cpp flag --selectivity=<s1>,<s2>,... Empty keeps the
+// synthetic values.
+inline vector<double> where_selectivity;
+
+inline void set_where_selectivity(const string& list)
+{
+    where_selectivity.clear();
+    stringstream ss(list);
+    string s;
+    while (getline(ss, s, ',')) {
+        auto sel = stod(s);
+        if (sel < 0 || sel > 1) {
+            throw runtime_error("Invalid selectivity " + s);
+        }
+        where_selectivity.push_back(sel);
+    }
+}
+
+// Kernel used by the compact where benchmarks, set once from the main.cpp
+// flag --simd=<auto|avx512|avx2|scalar>
+inline string simd_flag = "auto";
+
+enum class SimdLevel { SCALAR, AVX2, AVX512 };
+
+inline SimdLevel simd_level()
+{
+    bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    bool avx2 = __builtin_cpu_supports("avx2");
+    if (simd_flag == "scalar") {
+        return SimdLevel::SCALAR;
+    } else if (simd_flag == "avx2" || (simd_flag == "auto" && !avx512)) {
+        if (!avx2 && simd_flag == "avx2") {
+            throw runtime_error("CPU does not support AVX2");
+        }
+        return avx2 ? SimdLevel::AVX2 : SimdLevel::SCALAR;
+    } else if (simd_flag == "avx512" || simd_flag == "auto") {
+        if (!avx512) {
+            throw runtime_error("CPU does not support AVX-512");
+        }
+        return SimdLevel::AVX512;
+    }
+    throw runtime_error("Invalid SIMD level " + simd_flag);
+}
+
+// Lanes 2j (null) and 2j + 1 (data) of event j kept by an 8 bit mask over 4
+// events, in order. Unused slots repeat lane 0.
+struct CompressTable {
+    CompressTable()
+    {
+        for (int k = 0; k < 256; k++) {
+            int n = 0;
+            for (int l = 0; l < 8; l++) {
+                if (k & (1 << l)) {
+                    lanes[k][n++] = l;
+                }
+            }
+            for (; n < 8; n++) {
+                lanes[k][n] = 0;
+            }
+            for (int j = 0; j < 8; j++) {
+                auto e = lanes[k][j] >> 1;
+                auto data = (lanes[k][j] & 1) << 4;
+                words[k][2 * j] = (2 * e) | data;
+                words[k][2 * j + 1] = (2 * e + 1) | data;
+            }
+        }
+    }
+
+    array<array<uint8_t, 8>, 256> lanes;
+    // halves 2e and 2e + 1 of the event e of every lane, plus 16 on data
+    // lanes, which pshufb and vpermd ignore
+    array<array<uint8_t, 16>, 256> words;
+};
+
+inline const CompressTable kCompressTable;
+
+// Moves the bits of x to the even bits of the result
+inline uint16_t spread_bits(uint8_t x)
+{
+    uint16_t v = x;
+    v = (v | (v << 4)) & 0x0F0F;
+    v = (v | (v << 2)) & 0x3333;
+    v = (v | (v << 1)) & 0x5555;
+    return v;
+}
+
+// Interleaved (null, data) lane mask of 8 events kept by `m`. `prev` tells
+// whether the event before them was kept, and is updated for the next call.
+inline uint16_t where_lanes(uint8_t m, bool& prev)
+{
+    uint8_t n = m & ~((m << 1) | prev);
+    prev = m >> 7;
+    return spread_bits(n) | (spread_bits(m) << 1);
+}
+
+// First entry of `reg` ending after `t`
+inline idx_t where_first(region_t* reg, ts_t t)
+{
+    auto lo = get_start_idx(reg) + 1;
+    auto hi = get_end_idx(reg) + 1;
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        auto iv = reg->tl[mid & reg->mask];
+        if (iv.t + iv.d <= t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+template<typename T>
+inline void where_commit(region_t* out, const ival_t& iv, T v, bool keep, bool& prev)
+{
+    if (keep) {
+        if (!prev) {
+            commit_null(out, iv.t);
+        }
+        commit_data(out, iv.t + iv.d);
+        *reinterpret_cast<T*>(fetch(out, iv.t + iv.d, get_end_idx(out), sizeof(T))) = v;
+    }
+    prev = keep;
+}
+
+// Writes the lanes of 4 events kept by `k` from out->ei + 1 on. All 8 slots
+// are written, so the ring needs 8 free slots.
+template<typename T>
+inline void where_shuffle4(region_t* out, const ival_t* tl, const T* v, uint8_t k)
+{
+    auto& lanes = kCompressTable.lanes[k];
+    auto data = reinterpret_cast<T*>(out->data);
+    for (int j = 0; j < 8; j++) {
+        auto l = lanes[j];
+        auto idx = (out->ei + 1 + j) & out->mask;
+        out->tl[idx] = ival_t(tl[l >> 1].t, tl[l >> 1].d & -static_cast<dur_t>(l & 1));
+        data[idx] = v[l >> 1];
+    }
+    out->ei += __builtin_popcount(k);
+}
+
+// where_shuffle4 with vpermd and pshufb: the t and the d of the 4 events are
+// moved into a register each and permuted into the kept lanes, and so is the
+// payload. The 8 slots after out->ei must not wrap around the ring.
+template<typename T>
+__attribute__((target("avx2")))
+inline void where_shuffle4_avx2(region_t* out, const ival_t* tl, const T* v, uint8_t k)
+{
+    auto o = (out->ei + 1) & out->mask;
+    auto words = _mm_loadu_si128((const __m128i*) kCompressTable.words[k].data());
+    auto a = _mm256_loadu_si256((const __m256i*) tl);
+    auto b = _mm256_loadu_si256((const __m256i*) (tl + 2));
+    auto ts = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+    auto ds = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+    auto pair = _mm_setr_epi8(0, 1, 0, 1, 2, 3, 2, 3, 0, 0, 0, 0, 0, 0, 0, 0);
+    auto data = _mm256_set1_epi32(15);
+    for (int m = 0; m < 4; m++) {
+        // the halves of lanes 2m and 2m + 1, each once for t and once for d
+        auto idx = _mm256_cvtepu8_epi32(_mm_shuffle_epi8(words, _mm_add_epi8(pair, _mm_set1_epi8(4 * m))));
+        auto t = _mm256_permutevar8x32_epi32(ts, idx);
+        auto d = _mm256_and_si256(_mm256_permutevar8x32_epi32(ds, idx), _mm256_cmpgt_epi32(idx, data));
+        _mm256_storeu_si256((__m256i*) (out->tl + o + 2 * m), _mm256_blend_epi32(t, d, 0xCC));
+    }
+
+    auto dst = reinterpret_cast<T*>(out->data) + o;
+    if constexpr (sizeof(T) == 8) {
+        auto vals = _mm256_loadu_si256((const __m256i*) v);
+        _mm256_storeu_si256((__m256i*) dst, _mm256_permutevar8x32_epi32(vals, _mm256_cvtepu8_epi32(words)));
+        _mm256_storeu_si256((__m256i*) (dst + 4),
+            _mm256_permutevar8x32_epi32(vals, _mm256_cvtepu8_epi32(_mm_srli_si128(words, 8))));
+    } else if constexpr (sizeof(T) == 4) {
+        auto vals = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) v));
+        auto lanes = _mm_loadl_epi64((const __m128i*) kCompressTable.lanes[k].data());
+        auto idx = _mm256_srli_epi32(_mm256_cvtepu8_epi32(lanes), 1);
+        _mm256_storeu_si256((__m256i*) dst, _mm256_permutevar8x32_epi32(vals, idx));
+    } else if constexpr (sizeof(T) == 2) {
+        auto vals = _mm_loadl_epi64((const __m128i*) v);
+        _mm_storeu_si128((__m128i*) dst, _mm_shuffle_epi8(vals, words));
+    } else {
+        static_assert(sizeof(T) == 1, "Payloads of 1, 2, 4 or 8 bytes");
+        int32_t packed;
+        memcpy(&packed, v, sizeof(packed));
+        auto lanes = _mm_loadl_epi64((const __m128i*) kCompressTable.lanes[k].data());
+        auto idx = _mm_and_si128(_mm_srli_epi16(lanes, 1), _mm_set1_epi8(7));
+        _mm_storel_epi64((__m128i*) dst, _mm_shuffle_epi8(_mm_cvtsi32_si128(packed), idx));
+    }
+    out->ei += __builtin_popcount(k);
+}
+
+// Kernel over the input entries [first, last)
+typedef void (*WhereRange)(idx_t first, idx_t last, region_t* out, region_t* in);
+
+// Kernel `K` with the signature of the compiled query, over the input events
+// ending in (t_start, t_end]
+template<WhereRange K>
+region_t* where_query(ts_t t_start, ts_t t_end, region_t* out, region_t* in)
+{
+    K(where_first(in, t_start), where_first(in, t_end), out, in);
+    return out;
+}
+
+// Runs `block(tl, v, len, prev)` over the physically contiguous spans of the
+// input entries [first, last)
+template<typename T, typename F>
+inline void where_spans(idx_t first, idx_t last, region_t* out, region_t* in, F block)
+{
+    if (first >= last) {
+        return;
+    }
+    bool prev = (get_end_time(out) == in->tl[first & in->mask].t);
+    while (first < last) {
+        auto p = first & in->mask;
+        auto len = min<idx_t>(last - first, in->mask + 1 - p);
+        block(in->tl + p, reinterpret_cast<T*>(in->data) + p, len, prev);
+        first += len;
+    }
+}
+
+// Branching reference kernel, as the generated code of _Where
+template<typename T>
+void where_scalar(idx_t first, idx_t last, region_t* out, region_t* in)
+{
+    auto thr = static_cast<T>(where_threshold);
+    where_spans<T>(first, last, out, in, [out, thr](const ival_t* tl, const T* v, idx_t len, bool& prev) {
+        for (idx_t i = 0; i < len; i++) {
+            where_commit(out, tl[i], v[i], tl[i].d != 0 && v[i] > thr, prev);
+        }
+    });
+}
+
+// Branch-free scalar kernel: every event writes both of its lanes past the end
+// of the output and moves the end over the lanes it keeps, so the ring needs
+// 2 free slots
+template<typename T>
+void where_predicated(idx_t first, idx_t last, region_t* out, region_t* in)
+{
+    auto thr = static_cast<T>(where_threshold);
+    where_spans<T>(first, last, out, in, [out, thr](const ival_t* tl, const T* v, idx_t len, bool& prev) {
+        auto out_v = reinterpret_cast<T*>(out->data);
+        auto ei = out->ei;
+        for (idx_t i = 0; i < len; i++) {
+            bool keep = (tl[i].d != 0) & (v[i] > thr);
+            out->tl[(ei + 1) & out->mask] = ival_t(tl[i].t, 0);
+            ei += keep & !prev;
+            auto o = (ei + 1) & out->mask;
+            out->tl[o] = tl[i];
+            out_v[o] = v[i];
+            ei += keep;
+            prev = keep;
+        }
+        out->ei = ei;
+    });
+}
+
+template<typename T>
+__attribute__((target("avx2")))
+void where_avx2(idx_t first, idx_t last, region_t* out, region_t* in)
+{
+    auto thr = static_cast<T>(where_threshold);
+    auto tl = in->tl;
+    auto v = reinterpret_cast<T*>(in->data);
+    if (first >= last) {
+        return;
+    }
+    bool prev = (get_end_time(out) == tl[first & in->mask].t);
+    alignas(32) uint8_t flags[64];
+
+    while (first < last) {
+        auto p = first & in->mask;
+        auto len = min<idx_t>(last - first, in->mask + 1 - p);
+        idx_t i = 0;
+        for (; i + 64 <= len; i += 64) {
+            for (int j = 0; j < 64; j++) {
+                flags[j] = -((tl[p + i + j].d != 0) & (v[p + i + j] > thr));
+            }
+            uint64_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_load_si256((__m256i*) flags)))
+                | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(
+                    _mm256_load_si256((__m256i*) (flags + 32))))) << 32);
+            for (int g = 0; g < 64; g += 8) {
+                auto k = where_lanes(bits >> g, prev);
+                if (out->ei + 16 - out->si > out->mask) {
+                    throw runtime_error("Output region of the compact where is full");
+                }
+                if (((out->ei + 1) & out->mask) + 16 > out->mask + 1) {
+                    // the lanes would wrap around the ring
+                    where_shuffle4(out, tl + p + i + g, v + p + i + g, k & 0xFF);
+                    where_shuffle4(out, tl + p + i + g + 4, v + p + i + g + 4, k >> 8);
+                    continue;
+                }
+                where_shuffle4_avx2(out, tl + p + i + g, v + p + i + g, k & 0xFF);
+                where_shuffle4_avx2(out, tl + p + i + g + 4, v + p + i + g + 4, k >> 8);
+            }
+        }
+        for (; i < len; i++) {
+            where_commit(out, tl[p + i], v[p + i], tl[p + i].d != 0 && v[p + i] > thr, prev);
+        }
+        first += len;
+    }
+}
+
+template<typename T>
+__attribute__((target("avx512f,avx512bw")))
+void where_avx512(idx_t first, idx_t last, region_t* out, region_t* in)
+{
+    // 8 bit qword mask of the lanes (null, data) of two events
+    static const uint8_t kPairs[16] = {
+        0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+        0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF };
+
+    auto thr = static_cast<T>(where_threshold);
+    auto tl = in->tl;
+    auto v = reinterpret_cast<T*>(in->data);
+    if (first >= last) {
+        return;
+    }
+    bool prev = (get_end_time(out) == tl[first & in->mask].t);
+    alignas(64) uint8_t flags[64];
+
+    // candidate lanes (t, 0), (t, d) of the first and the second pair of 4 events
+    auto lo_idx = _mm512_setr_epi64(0, 0, 0, 1, 2, 2, 2, 3);
+    auto hi_idx = _mm512_setr_epi64(4, 4, 4, 5, 6, 6, 6, 7);
+    auto dup32 = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    auto dup64 = _mm512_setr_epi64(0, 0, 1, 1, 2, 2, 3, 3);
+    auto out_tl = out->tl;
+    auto out_v = reinterpret_cast<T*>(out->data);
+
+    while (first < last) {
+        auto p = first & in->mask;
+        auto len = min<idx_t>(last - first, in->mask + 1 - p);
+        idx_t i = 0;
+        for (; i + 64 <= len; i += 64) {
+            for (int j = 0; j < 64; j++) {
+                flags[j] = (tl[p + i + j].d != 0) & (v[p + i + j] > thr);
+            }
+            auto f = _mm512_load_si512(flags);
+            uint64_t bits = _mm512_test_epi8_mask(f, f);
+
+            for (int g = 0; g < 64; g += 8) {
+                auto k = where_lanes(bits >> g, prev);
+                if (out->ei + 16 - out->si > out->mask) {
+                    throw runtime_error("Output region of the compact where is full");
+                }
+                auto o = (out->ei + 1) & out->mask;
+                if (o + 16 > out->mask + 1) {
+                    // the lanes would wrap around the ring
+                    where_shuffle4(out, tl + p + i + g, v + p + i + g, k & 0xFF);
+                    where_shuffle4(out, tl + p + i + g + 4, v + p + i + g + 4, k >> 8);
+                    continue;
+                }
+
+                auto src = tl + p + i + g;
+                int n = 0;
+                for (int h = 0; h < 2; h++) {
+                    auto ivs = _mm512_loadu_si512(src + 4 * h);
+                    uint8_t k_lo = (k >> (8 * h)) & 0xF;
+                    uint8_t k_hi = (k >> (8 * h + 4)) & 0xF;
+                    _mm512_mask_compressstoreu_epi64(out_tl + o + n, kPairs[k_lo],
+                        _mm512_maskz_permutexvar_epi64(0xDD, lo_idx, ivs));
+                    n += __builtin_popcount(k_lo);
+                    _mm512_mask_compressstoreu_epi64(out_tl + o + n, kPairs[k_hi],
+                        _mm512_maskz_permutexvar_epi64(0xDD, hi_idx, ivs));
+                    n += __builtin_popcount(k_hi);
+                }
+
+                auto src_v = v + p + i + g;
+                if constexpr (sizeof(T) == 4) {
+                    auto vals = _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i*) src_v));
+                    _mm512_mask_compressstoreu_epi32(out_v + o, k, _mm512_permutexvar_epi32(dup32, vals));
+                } else if constexpr (sizeof(T) == 8) {
+                    auto lo = _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i*) src_v));
+                    auto hi = _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i*) (src_v + 4)));
+                    _mm512_mask_compressstoreu_epi64(out_v + o, k & 0xFF, _mm512_permutexvar_epi64(dup64, lo));
+                    _mm512_mask_compressstoreu_epi64(out_v + o + __builtin_popcount(k & 0xFF), k >> 8,
+                        _mm512_permutexvar_epi64(dup64, hi));
+                } else {
+                    // no byte and word compress without VBMI2, fall back to the table
+                    auto& lo = kCompressTable.lanes[k & 0xFF];
+                    auto& hi = kCompressTable.lanes[k >> 8];
+                    auto n_lo = __builtin_popcount(k & 0xFF);
+                    for (int j = 0; j < 8; j++) {
+                        out_v[o + j] = src_v[lo[j] >> 1];
+                    }
+                    for (int j = 0; j < 8; j++) {
+                        out_v[o + n_lo + j] = src_v[4 + (hi[j] >> 1)];
+                    }
+                }
+                out->ei += n;
+            }
+        }
+        for (; i < len; i++) {
+            where_commit(out, tl[p + i], v[p + i], tl[p + i].d != 0 && v[p + i] > thr, prev);
+        }
+        first += len;
+    }
+}
+
+enum class WhereVariant { BRANCH, PREDICATED, COMPRESS };
+
+// Blocks the adaptive kernel ran on each variant and the times it switched,
+// over all calls of the process
+inline atomic<int64_t> where_blocks[3];
+inline atomic<int64_t> where_switches{0};
+
+// Events per block of the adaptive kernel, the events it samples per block and
+// the dense blocks after which it times the dense variant it is not using
+inline constexpr idx_t kWhereBlock = 4096;
+inline constexpr idx_t kWhereSamples = 128;
+inline constexpr int64_t kWhereProbe = 64;
+
+// Choice of the adaptive kernel, kept across the slices of a thread
+struct WhereAdaptive {
+    WhereVariant cur = WhereVariant::BRANCH;
+    WhereVariant dense = WhereVariant::PREDICATED;
+    // moving average of the ns per event of each variant
+    double ns[3] = {0, 0, 0};
+    int64_t dense_blocks = 0;
+};
+
+inline thread_local WhereAdaptive where_adaptive_state;
+
+// Runs every block of kWhereBlock events on a variant picked from the
+// selectivity of kWhereSamples events spread over it. Near 0 and 1 that is
+// the branch, which is left at a wider margin than it is taken, so a
+// selectivity on the edge does not switch on every block. In between it is
+// the faster of the predicated and the compress variant, which the kernel
+// times as it goes, as which one wins depends on the CPU and the payload
+// width. The compress variant is the kernel of --simd and is not used at
+// SimdLevel::SCALAR.
+template<typename T>
+void where_adaptive(idx_t first, idx_t last, region_t* out, region_t* in)
+{
+    WhereRange compress = nullptr;
+    switch (simd_level()) {
+        case SimdLevel::AVX512:
+            compress = &where_avx512<T>;
+            break;
+        case SimdLevel::AVX2:
+            compress = &where_avx2<T>;
+            break;
+        default:
+            break;
+    }
+    const WhereRange kernels[3] = {&where_scalar<T>, &where_predicated<T>, compress};
+    const int pred = static_cast<int>(WhereVariant::PREDICATED);
+    const int comp = static_cast<int>(WhereVariant::COMPRESS);
+
+    auto& s = where_adaptive_state;
+    auto thr = static_cast<T>(where_threshold);
+    auto v = reinterpret_cast<T*>(in->data);
+    int64_t blocks[3] = {0, 0, 0};
+    int64_t switches = 0;
+    for (auto i = first; i < last; i += kWhereBlock) {
+        auto n = min(kWhereBlock, last - i);
+        int64_t seen = 0, kept = 0;
+        for (auto j = i; j < i + n; j += max<idx_t>(n / kWhereSamples, 1)) {
+            auto e = j & in->mask;
+            if (in->tl[e].d != 0) {
+                seen++;
+                kept += (v[e] > thr);
+            }
+        }
+        auto sel = seen ? (double) kept / seen : 0;
+        auto edge = (s.cur == WhereVariant::BRANCH) ? 0.08 : 0.03;
+        auto next = WhereVariant::BRANCH;
+        if (sel >= edge && sel <= 1 - edge) {
+            auto other = (s.dense == WhereVariant::PREDICATED) ? WhereVariant::COMPRESS : WhereVariant::PREDICATED;
+            bool probe = compress && (s.ns[static_cast<int>(other)] == 0 || s.dense_blocks % kWhereProbe == 0);
+            next = probe ? other : s.dense;
+            s.dense_blocks++;
+        }
+        switches += (next != s.cur);
+        s.cur = next;
+
+        auto k = static_cast<int>(s.cur);
+        if (s.cur == WhereVariant::BRANCH) {
+            kernels[k](i, i + n, out, in);
+        } else {
+            auto start = chrono::steady_clock::now();
+            kernels[k](i, i + n, out, in);
+            auto ns = (double) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / n;
+            s.ns[k] = (s.ns[k] == 0) ? ns : 0.75 * s.ns[k] + 0.25 * ns;
+            if (s.ns[comp] > 0 && s.ns[pred] > 0) {
+                s.dense = (s.ns[comp] < s.ns[pred]) ? WhereVariant::COMPRESS : WhereVariant::PREDICATED;
+            }
+        }
+        blocks[k]++;
+    }
+
+    for (int k = 0; k < 3; k++) {
+        where_blocks[k] += blocks[k];
+    }
+    where_switches += switches;
+}
+
+// Rewrites the payloads of `reg` to pass the where predicate with the
+// selectivities of where_selectivity, one after the other over equal phases
+// of the events
+template<typename T>
+void where_shape(region_t* reg)
+{
+    mt19937_64 gen(arrival_spec.seed);
+    uniform_real_distribution<double> u(0, 1);
+    auto keep = static_cast<T>(where_threshold + 1);
+    auto drop = static_cast<T>(where_threshold - 1);
+    auto v = reinterpret_cast<T*>(reg->data);
+    auto lo = get_start_idx(reg);
+    auto hi = get_end_idx(reg);
+    int64_t phases = where_selectivity.size();
+    for (auto i = lo; i <= hi; i++) {
+        auto s = where_selectivity[min(phases - 1, (i - lo) * phases / (hi - lo + 1))];
+        v[i & reg->mask] = (u(gen) < s) ? keep : drop;
+    }
+}
+
+// Native where at every payload width, run through the same slicing as the
+// compiled queries
+template<typename T>
+class CompactWhereBench : public Benchmark {
+public:
+    CompactWhereBench(dur_t period, int64_t size) :
+        period(period), size(size)
+    {}
+
+    bool partitionable() override { return true; }
+
+    bool native() override { return true; }
+
+    // no TiLT query to compile, the kernel takes the place of the compiled code
+    intptr_t compile() override
+    {
+        if (where_kernel == "branch") {
+            return reinterpret_cast<intptr_t>(&where_query<where_scalar<T>>);
+        } else if (where_kernel == "predicated") {
+            return reinterpret_cast<intptr_t>(&where_query<where_predicated<T>>);
+        } else if (where_kernel == "adaptive") {
+            return reinterpret_cast<intptr_t>(&where_query<where_adaptive<T>>);
+        } else if (where_kernel != "compress") {
+            throw runtime_error("Invalid where kernel " + where_kernel);
+        }
+        switch (simd_level()) {
+            case SimdLevel::AVX512:
+                return reinterpret_cast<intptr_t>(&where_query<where_avx512<T>>);
+            case SimdLevel::AVX2:
+                return reinterpret_cast<intptr_t>(&where_query<where_avx2<T>>);
+            default:
+                return reinterpret_cast<intptr_t>(&where_query<where_scalar<T>>);
+        }
+    }
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Compact where benchmarks have no TiLT query");
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<T>(size);
+        WidthOps<T>::fill(&in_reg, period, size);
+        if (!where_selectivity.empty()) {
+            where_shape<T>(&in_reg);
+        }
+        // the kernels write up to 16 lanes ahead
+        out_reg = create_out_reg<T>(size + 16, size);
+        input_bytes = reg_bytes<T>(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        run_query(addr, period * size, size, 1, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_where<T>(&in_reg, WidthOps<T>::ref_filter));
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    dur_t period;
+    int64_t size;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+// Runs testcase compactwhere_<type>, with type one of i8, i16, i32, i64, f32 and f64
+class ParallelCompactWhereBench : public ParallelBenchmark {
+public:
+    ParallelCompactWhereBench(int threads, const string& testcase, dur_t period, int64_t size)
+    {
+        auto type = testcase.substr(testcase.find('_') + 1);
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(make(type, period, size));
+        }
+    }
+
+private:
+    static Benchmark* make(const string& type, dur_t period, int64_t size)
+    {
+        if (type == "i8") {
+            return new CompactWhereBench<int8_t>(period, size);
+        } else if (type == "i16") {
+            return new CompactWhereBench<int16_t>(period, size);
+        } else if (type == "i32") {
+            return new CompactWhereBench<int32_t>(period, size);
+        } else if (type == "i64") {
+            return new CompactWhereBench<int64_t>(period, size);
+        } else if (type == "f32") {
+            return new CompactWhereBench<float>(period, size);
+        } else if (type == "f64") {
+            return new CompactWhereBench<double>(period, size);
+        }
+        throw runtime_error("Invalid payload type " + type);
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_COMPACT_H_
@@ -0,0 +1,525 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_COMPRESS_H_
+#define TILT_BENCH_INCLUDE_TILT_COMPRESS_H_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+#include "tilt_base.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Compressed integer columns.
+ *
+ * Frame-of-reference regions generalize the base + delta prototype of
+ * bd_tilt_select.h / bd_tilt_where.h: a column of T (INT64/INT32) is stored as
+ * a base stream with one event per block of `block` periods and a residual
+ * stream of narrow R (INT8/INT16/INT32) holding value - base. The residual
+ * stream keeps the original timeline, and the compiled operators below read
+ * both streams directly, so decoding happens inside the generated loop.
+ *
+ * The compiled path is frame-of-reference only. Delta decoding needs a running
+ * sum over the residuals, which would put recursive state in every operator.
+ *
+ * PackedColumn is the bit-granular format (frame-of-reference or zigzag delta
+ * per block, bit-packed at the smallest width that fits). TiLT cannot express
+ * bit extraction, so it is scanned by native kernels, and delta blocks exist
+ * only there. */
+
+// Ingest-time encoder of a plain region of T into base and residual regions.
+template<typename T, typename R>
+void for_encode(region_t* in, dur_t period, int64_t block, region_t* base, region_t* resid)
+{
+    auto bperiod = period * block;
+    auto end = get_end_idx(in);
+    auto i = get_start_idx(in);
+
+    while (i <= end) {
+        // null intervals carry no value and belong to no block
+        if (in->tl[i & in->mask].d == 0) {
+            i++;
+            continue;
+        }
+
+        // an event is decoded with the base event covering its end time, so
+        // blocks group events by end time into (block_end - bperiod, block_end]
+        auto first = in->tl[i & in->mask];
+        auto block_end = ((first.t + first.d + bperiod - 1) / bperiod) * bperiod;
+
+        // find the value range of the block
+        T lo = numeric_limits<T>::max();
+        T hi = numeric_limits<T>::min();
+        auto j = i;
+        for (; j <= end && in->tl[j & in->mask].t + in->tl[j & in->mask].d <= block_end; j++) {
+            auto iv = in->tl[j & in->mask];
+            if (iv.d > 0) {
+                auto v = *reinterpret_cast<T*>(fetch(in, iv.t + iv.d, j, sizeof(T)));
+                lo = min(lo, v);
+                hi = max(hi, v);
+            }
+        }
+        if (lo > hi) {
+            lo = hi = 0;
+        }
+        if (static_cast<int64_t>(hi) - lo > static_cast<int64_t>(numeric_limits<R>::max()) - numeric_limits<R>::min()) {
+            throw runtime_error("Block range exceeds the residual width");
+        }
+        T b = lo - numeric_limits<R>::min();
+
+        if (get_end_time(base) < block_end - bperiod) {
+            commit_null(base, block_end - bperiod);
+        }
+        commit_data(base, block_end);
+        *reinterpret_cast<T*>(fetch(base, block_end, get_end_idx(base), sizeof(T))) = b;
+
+        for (; i < j; i++) {
+            auto iv = in->tl[i & in->mask];
+            if (iv.d == 0) {
+                continue;
+            }
+            auto t = iv.t + iv.d;
+            auto v = *reinterpret_cast<T*>(fetch(in, t, i, sizeof(T)));
+            if (get_end_time(resid) < iv.t) {
+                commit_null(resid, iv.t);
+            }
+            commit_data(resid, t);
+            *reinterpret_cast<R*>(fetch(resid, t, get_end_idx(resid), sizeof(R))) = static_cast<R>(v - b);
+        }
+    }
+}
+
+Op _FORSelect(_sym base, _sym resid, DataType vtype, function<Expr(Expr)> op)
+{
+    auto e_base = base[_pt(0)];
+    auto e_base_sym = _sym("base", e_base);
+    auto e_resid = resid[_pt(0)];
+    auto e_resid_sym = _sym("resid", e_resid);
+    auto res = op(e_base_sym + _cast(vtype, e_resid_sym));
+    auto res_sym = _sym("res", res);
+
+    return _op(
+        _iter(0, 1),
+        Params{ base, resid },
+        SymTable{
+            {e_base_sym, e_base},
+            {e_resid_sym, e_resid},
+            {res_sym, res},
+        },
+        _exists(e_resid_sym),
+        res_sym);
+}
+
+Op _FORWhere(_sym base, _sym resid, DataType vtype, function<Expr(Expr)> filter)
+{
+    auto e_base = base[_pt(0)];
+    auto e_base_sym = _sym("base", e_base);
+    auto e_resid = resid[_pt(0)];
+    auto e_resid_sym = _sym("resid", e_resid);
+    auto val = e_base_sym + _cast(vtype, e_resid_sym);
+    auto val_sym = _sym("val", val);
+
+    return _op(
+        _iter(0, 1),
+        Params{ base, resid },
+        SymTable{
+            {e_base_sym, e_base},
+            {e_resid_sym, e_resid},
+            {val_sym, val},
+        },
+        _exists(e_resid_sym) && filter(val_sym),
+        val_sym);
+}
+
+Op _FORWindowSum(_sym base, _sym resid, int64_t w, DataType vtype, Expr zero)
+{
+    auto bwin = base[_win(-w, 0)];
+    auto bwin_sym = _sym("bwin", bwin);
+    auto rwin = resid[_win(-w, 0)];
+    auto rwin_sym = _sym("rwin", rwin);
+
+    auto dec = _FORSelect(bwin_sym, rwin_sym, vtype, [](Expr e) { return e; });
+    auto dec_sym = _sym("dec", dec);
+
+    auto acc = [](Expr s, Expr st, Expr et, Expr d) { return _add(s, d); };
+    auto sum = _red(dec_sym, zero, acc);
+    auto sum_sym = _sym("sum", sum);
+
+    return _op(
+        _iter(0, w),
+        Params{ base, resid },
+        SymTable{
+            {bwin_sym, bwin},
+            {rwin_sym, rwin},
+            {dec_sym, dec},
+            {sum_sym, sum},
+        },
+        _true(),
+        sum_sym);
+}
+
+enum class CompOp { SELECT, WHERE, SUM };
+
+// Reference of the select / where / tumbling sum queries of this file and of
+// tilt_implicit.h over their plain input. Windows without events have no
+// output, which the dense inputs of the FOR and packed benchmarks never have.
+template<typename T>
+vector<RefEvent<T>> ref_comp(region_t* in, CompOp op, dur_t w)
+{
+    switch (op) {
+        case CompOp::SELECT:
+            return ref_select<T, T>(in, [](T v) -> T { return v + 3; });
+        case CompOp::WHERE:
+            return ref_where<T>(in, [](T v) { return v > 0; });
+        default:
+            return ref_tumble_sum<T>(in, w);
+    }
+}
+
+template<typename T, typename R>
+class FORBench : public Benchmark {
+public:
+    FORBench(CompOp op, dur_t period, int64_t block, int64_t w, int64_t size) :
+        op(op), period(period), block(block), w(w), size(size)
+    {}
+
+private:
+    Op query() final
+    {
+        auto vtype = TiltType<T>::type();
+        auto base_sym = _sym("base", tilt::Type(vtype, _iter(0, -1)));
+        auto resid_sym = _sym("resid", tilt::Type(TiltType<R>::type(), _iter(0, -1)));
+        switch (op) {
+            case CompOp::SELECT:
+                return _FORSelect(base_sym, resid_sym, vtype, [](Expr e) { return e + TiltType<T>::val(3); });
+            case CompOp::WHERE:
+                return _FORWhere(base_sym, resid_sym, vtype, [](Expr e) { return _gt(e, TiltType<T>::val(0)); });
+            default:
+                return _FORWindowSum(base_sym, resid_sym, w, vtype, TiltType<T>::val(0));
+        }
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<T>(size);
+        SynthData<T> dataset(period, size);
+        dataset.fill(&in_reg);
+
+        base_reg = create_reg<T>(size / block + 1);
+        resid_reg = create_in_reg<R>(size);
+        for_encode<T, R>(&in_reg, period, block, &base_reg, &resid_reg);
+        // the reference needs the plain column
+        if (!verify_output) {
+            release_reg(&in_reg);
+        }
+
+        out_reg = create_reg<T>((op == CompOp::SUM) ? size / (w / period) + 1 : size);
+
+        input_bytes = reg_bytes<T>(&base_reg) + reg_bytes<R>(&resid_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr;
+        query(0, period * size, &out_reg, &base_reg, &resid_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_comp<T>(&in_reg, op, w));
+    }
+
+    void release() final
+    {
+#ifdef _PRINT_REGION_
+        print_reg<T>(&base_reg, "for_base_reg.txt");
+        print_reg<R>(&resid_reg, "for_resid_reg.txt");
+        print_reg<T>(&out_reg, "for_out_reg.txt");
+#endif
+        if (verify_output) {
+            release_reg(&in_reg);
+        }
+        release_reg(&base_reg);
+        release_reg(&resid_reg);
+        release_reg(&out_reg);
+    }
+
+    CompOp op;
+    dur_t period;
+    int64_t block; // periods per base event
+    int64_t w;
+    int64_t size;
+    region_t in_reg;
+    region_t base_reg;
+    region_t resid_reg;
+    region_t out_reg;
+};
+
+template<typename T, typename R>
+class ParallelFORBench : public ParallelBenchmark {
+public:
+    ParallelFORBench(int threads, CompOp op, dur_t period, int64_t block, int64_t w, int64_t size)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new FORBench<T, R>(op, period, block, w, size));
+        }
+    }
+};
+
+// Bit-packed column of T. Each block stores either value - min (FOR) or the
+// zigzag encoded difference to the previous value (DELTA), whichever needs
+// fewer bits, packed back to back at that width.
+template<typename T>
+class PackedColumn {
+public:
+    enum Mode : uint8_t { FOR, DELTA };
+
+    struct Block {
+        T base;
+        uint8_t mode;
+        uint8_t width;
+        uint32_t count;
+        int64_t bit;
+    };
+
+    explicit PackedColumn(int64_t block) : block(block) {}
+
+    void encode(const vector<T>& vals)
+    {
+        for (int64_t i = 0; i < static_cast<int64_t>(vals.size()); i += block) {
+            auto n = min<int64_t>(block, vals.size() - i);
+            auto* v = vals.data() + i;
+
+            T lo = *min_element(v, v + n);
+            T hi = *max_element(v, v + n);
+            uint64_t max_delta = 0;
+            for (int64_t j = 1; j < n; j++) {
+                max_delta = max(max_delta, zigzag(static_cast<int64_t>(v[j]) - v[j - 1]));
+            }
+
+            auto for_width = bits(static_cast<uint64_t>(static_cast<int64_t>(hi) - lo));
+            auto delta_width = bits(max_delta);
+
+            Block b;
+            b.count = n;
+            b.bit = nbits;
+            if (delta_width < for_width) {
+                b.mode = DELTA;
+                b.width = delta_width;
+                b.base = v[0];
+                for (int64_t j = 1; j < n; j++) {
+                    put(zigzag(static_cast<int64_t>(v[j]) - v[j - 1]), b.width);
+                }
+            } else {
+                b.mode = FOR;
+                b.width = for_width;
+                b.base = lo;
+                for (int64_t j = 0; j < n; j++) {
+                    put(static_cast<uint64_t>(static_cast<int64_t>(v[j]) - lo), b.width);
+                }
+            }
+            blocks.push_back(b);
+        }
+    }
+
+    // calls f(i, value) for every value, decoding block by block
+    template<typename F>
+    void scan(F f) const
+    {
+        int64_t i = 0;
+        for (auto& b : blocks) {
+            auto bit = b.bit;
+            if (b.mode == FOR) {
+                for (uint32_t j = 0; j < b.count; j++, bit += b.width) {
+                    f(i++, static_cast<T>(b.base + static_cast<int64_t>(get(bit, b.width))));
+                }
+            } else {
+                int64_t v = b.base;
+                f(i++, static_cast<T>(v));
+                for (uint32_t j = 1; j < b.count; j++, bit += b.width) {
+                    v += unzigzag(get(bit, b.width));
+                    f(i++, static_cast<T>(v));
+                }
+            }
+        }
+    }
+
+    int64_t bytes() const
+    {
+        return words.size() * sizeof(uint64_t) + blocks.size() * sizeof(Block);
+    }
+
+private:
+    static uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+    static int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+    static uint8_t bits(uint64_t v) { return v ? 64 - __builtin_clzll(v) : 0; }
+
+    void put(uint64_t v, uint8_t width)
+    {
+        if (width == 0) {
+            return;
+        }
+        auto word = nbits / 64;
+        auto off = nbits % 64;
+        if (word + 1 >= static_cast<int64_t>(words.size())) {
+            words.resize(word + 2, 0);
+        }
+        words[word] |= v << off;
+        if (off + width > 64) {
+            words[word + 1] |= v >> (64 - off);
+        }
+        nbits += width;
+    }
+
+    uint64_t get(int64_t bit, uint8_t width) const
+    {
+        if (width == 0) {
+            return 0;
+        }
+        auto word = bit / 64;
+        auto off = bit % 64;
+        uint64_t v = words[word] >> off;
+        if (off + width > 64) {
+            v |= words[word + 1] << (64 - off);
+        }
+        return (width == 64) ? v : v & ((1ull << width) - 1);
+    }
+
+    int64_t block;
+    int64_t nbits = 0;
+    vector<Block> blocks;
+    vector<uint64_t> words;
+};
+
+// Native select / where / tumbling window sum reading a PackedColumn of a
+// dense periodic stream directly, writing plain output regions
+template<typename T>
+class PackedBench : public Benchmark {
+public:
+    PackedBench(CompOp op, dur_t period, int64_t block, int64_t w, int64_t size) :
+        op(op), period(period), block(block), w(w), size(size)
+    {}
+
+    bool native() override { return true; }
+
+    intptr_t compile() override { return 0; }
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Packed benchmarks have no TiLT query");
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<T>(size);
+        SynthData<T> dataset(period, size);
+        dataset.fill(&in_reg);
+
+        // the column keeps no timeline, execute() rebuilds the k-th timestamp
+        // as period * (k + 1), so the input must be dense and periodic
+        vector<T> vals;
+        vals.reserve(size);
+        for (auto i = get_start_idx(&in_reg); i <= get_end_idx(&in_reg); i++) {
+            auto iv = in_reg.tl[i & in_reg.mask];
+            if (iv.d > 0) {
+                if (iv.t + iv.d != period * static_cast<ts_t>(vals.size() + 1)) {
+                    release_reg(&in_reg);
+                    throw runtime_error("Packed benchmarks need a dense periodic input (no --arrival)");
+                }
+                vals.push_back(*reinterpret_cast<T*>(fetch(&in_reg, iv.t + iv.d, i, sizeof(T))));
+            }
+        }
+        // the reference needs the plain column
+        if (!verify_output) {
+            release_reg(&in_reg);
+        }
+
+        col = new PackedColumn<T>(block);
+        col->encode(vals);
+
+        out_reg = create_reg<T>((op == CompOp::SUM) ? size / (w / period) + 1 : size);
+
+        input_bytes = col->bytes();
+    }
+
+    void execute(intptr_t) final
+    {
+        auto out = &out_reg;
+        auto p = period;
+        switch (op) {
+            case CompOp::SELECT:
+                col->scan([out, p](int64_t i, T v) {
+                    auto t = p * (i + 1);
+                    commit_data(out, t);
+                    *reinterpret_cast<T*>(fetch(out, t, get_end_idx(out), sizeof(T))) = v + 3;
+                });
+                break;
+            case CompOp::WHERE:
+                col->scan([out, p](int64_t i, T v) {
+                    if (v > 0) {
+                        auto t = p * (i + 1);
+                        if (get_end_time(out) < t - p) {
+                            commit_null(out, t - p);
+                        }
+                        commit_data(out, t);
+                        *reinterpret_cast<T*>(fetch(out, t, get_end_idx(out), sizeof(T))) = v;
+                    }
+                });
+                break;
+            default: {
+                auto wn = w / p;
+                T sum = 0;
+                col->scan([out, p, wn, &sum](int64_t i, T v) {
+                    sum += v;
+                    if ((i + 1) % wn == 0) {
+                        auto t = p * (i + 1);
+                        commit_data(out, t);
+                        *reinterpret_cast<T*>(fetch(out, t, get_end_idx(out), sizeof(T))) = sum;
+                        sum = 0;
+                    }
+                });
+                break;
+            }
+        }
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_comp<T>(&in_reg, op, w));
+    }
+
+    void release() final
+    {
+        if (verify_output) {
+            release_reg(&in_reg);
+        }
+        release_reg(&out_reg);
+        delete col;
+    }
+
+    CompOp op;
+    dur_t period;
+    int64_t block;
+    int64_t w;
+    int64_t size;
+    region_t in_reg;
+    PackedColumn<T>* col;
+    region_t out_reg;
+};
+
+template<typename T>
+class ParallelPackedBench : public ParallelBenchmark {
+public:
+    ParallelPackedBench(int threads, CompOp op, dur_t period, int64_t block, int64_t w, int64_t size)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new PackedBench<T>(op, period, block, w, size));
+        }
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_COMPRESS_H_
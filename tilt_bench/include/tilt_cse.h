@@ -0,0 +1,87 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_CSE_H_
+#define TILT_BENCH_INCLUDE_TILT_CSE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "tilt/builder/tilder.h"
+
+using namespace std;
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Common subexpression elimination of window reductions.
+ *
+ * The reductions and window operations of tilt_base.h are built from fixed
+ * accumulators, so two of them over the same input with the same parameters
+ * compute the same values, though _red keeps each accumulator as an opaque
+ * function. Their builders record a structural key of every such expression,
+ * and before code generation cse() rebinds each symbol of an operation defined
+ * by the same key as another symbol of that operation to the other symbol, so
+ * LoopGen folds the window once and copies the result. Set --cse=0 in
+ * main.cpp to compile the queries as written. */
+
+// Whether compile_op eliminates duplicate reductions
+inline bool cse_enabled = true;
+
+// Symbol definitions eliminated by all cse() calls of the process
+inline int64_t cse_eliminated = 0;
+
+// Structural keys of the expressions built by the keyed builders. The entries
+// hold weak references, so a key never outlives its expression.
+inline map<weak_ptr<ExprNode>, string, owner_less<weak_ptr<ExprNode>>> cse_keys;
+
+// Identity of a symbol in a key: expressions keep the symbols they read
+// alive, so the address is unique among the expressions of a key
+string cse_id(const Sym& sym)
+{
+    return to_string(reinterpret_cast<uintptr_t>(sym.get()));
+}
+
+// Records `key` as the structure of `e` and returns `e`
+template<typename E>
+E cse_key(E e, const string& key)
+{
+    cse_keys[e] = key;
+    return e;
+}
+
+// Rebinds the duplicate symbols of `op` and of the operations nested in it,
+// returns how many symbol definitions were dropped
+int64_t cse_op(Op op)
+{
+    int64_t eliminated = 0;
+    for (auto& entry : op->syms) {
+        if (auto sub = dynamic_pointer_cast<OpNode>(entry.second)) {
+            eliminated += cse_op(sub);
+        }
+    }
+
+    map<string, Sym> first;
+    for (auto& entry : op->syms) {
+        auto it = cse_keys.find(entry.second);
+        if (it == cse_keys.end()) {
+            continue;
+        }
+        auto res = first.insert({it->second, entry.first});
+        if (!res.second) {
+            entry.second = res.first->second;
+            eliminated++;
+        }
+    }
+    return eliminated;
+}
+
+int64_t cse(Op op)
+{
+    auto eliminated = cse_op(op);
+    cse_eliminated += eliminated;
+
+    for (auto it = cse_keys.begin(); it != cse_keys.end();) {
+        it = it->first.expired() ? cse_keys.erase(it) : next(it);
+    }
+    return eliminated;
+}
+
+#endif  // TILT_BENCH_INCLUDE_TILT_CSE_H_
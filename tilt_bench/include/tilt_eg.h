@@ -323,7 +323,7 @@ public:
 protected:
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         out_reg = create_reg<bool>(size);
 
         SynthData<float> dataset(period, size);
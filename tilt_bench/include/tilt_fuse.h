@@ -0,0 +1,322 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_FUSE_H_
+#define TILT_BENCH_INCLUDE_TILT_FUSE_H_
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+#include "tilt_peak.h"
+#include "tilt_compact.h"
+#include "tilt_reduce.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Producer-consumer fusion of composite queries.
+ *
+ * The compiled _PanTom writes every event of lp, hp, derv and ma to a region
+ * of its own, which the next operator reads back, and _Norm does the same with
+ * the centered values of avgop. These native kernels run in place of the
+ * compiled query and take every event through all operators in one loop. A
+ * point-wise consumer reads the value of its producer from a register, and a
+ * consumer looking back a bounded number of events reads it from a ring that
+ * holds just that many, so the intermediate streams are never materialized.
+ * The benchmarks report the bytes of intermediate regions the compiled query
+ * writes and the kernel does not. */
+
+// Bytes of intermediate data the compiled query writes and the fused kernel
+// does not in its last run, and the bytes of the rings it keeps instead
+class FusionStats : public Benchmark {
+public:
+    int64_t eliminated_bytes = 0;
+    int64_t ring_bytes = 0;
+};
+
+// The last values of an intermediate stream, as far back as its consumers look
+class FuseRing {
+public:
+    explicit FuseRing(int64_t lookback) :
+        vals(get_buf_size(lookback + 1), 0), mask(vals.size() - 1)
+    {}
+
+    // value `back` >= 1 events before the next one, 0 before the stream starts
+    float at(int64_t back) const { return (n >= back) ? vals[(n - back) & mask] : 0; }
+
+    void push(float v) { vals[n++ & mask] = v; }
+
+    int64_t bytes() const { return vals.size() * sizeof(float); }
+
+private:
+    vector<float> vals;
+    int64_t mask;
+    int64_t n = 0;
+};
+
+// State of the fused _PanTom between invocations, passed to the kernel as the
+// payload of a state region as the compiled query gets its Aux regions
+struct PanTomStream {
+    PanTomStream(dur_t p, int64_t back) :
+        p(p), back(back), x(12), lp(32), hp(4), derv(back)
+    {}
+
+    int64_t bytes() const { return x.bytes() + lp.bytes() + hp.bytes() + derv.bytes(); }
+
+    dur_t p;
+    int64_t back;
+    FuseRing x;
+    FuseRing lp;
+    FuseRing hp;
+    FuseRing derv;
+    float sum = 0;
+    float count = 0;
+    int64_t seen = 0;
+};
+
+// _PanTom with the streams between its operators dense, as in ref_pantom
+region_t* pantom_stream(ts_t t_start, ts_t t_end, region_t* out, region_t* in, region_t* state)
+{
+    auto& s = *reinterpret_cast<PanTomStream*>(state->data);
+    auto first = where_first(in, t_start);
+    auto last = where_first(in, t_end);
+    if (first >= last) {
+        return out;
+    }
+
+    auto vals = reinterpret_cast<float*>(in->data);
+    bool prev = (get_end_time(out) == in->tl[first & in->mask].t);
+    for (auto i = first; i < last; i++) {
+        auto iv = in->tl[i & in->mask];
+        if (iv.d == 0) {
+            where_commit(out, iv, 0.0f, false, prev);
+            continue;
+        }
+        auto x = vals[i & in->mask];
+        auto lp = (2.0f * s.lp.at(1)) - s.lp.at(2) + x - (2.0f * s.x.at(6)) + s.x.at(12);
+        auto hp = (32.0f * s.lp.at(16)) - s.hp.at(1) + lp - s.lp.at(32);
+        auto derv = static_cast<float>(s.p / 8) * (hp + (2.0f * s.hp.at(1)) - (2.0f * s.hp.at(3)) - s.hp.at(4));
+        auto tail = s.derv.at(s.back);
+        s.sum = (s.sum + derv * derv) - tail * tail;
+        s.count = (s.count + 1) - ((s.seen >= s.back) ? 1 : 0);
+        s.seen++;
+
+        s.x.push(x);
+        s.lp.push(lp);
+        s.hp.push(hp);
+        s.derv.push(derv);
+        where_commit(out, iv, s.sum / s.count, true, prev);
+    }
+    return out;
+}
+
+// Window of the fused _Norm, set by compile() as the generated code has its
+// window built in
+inline dur_t norm_stream_window = 0;
+
+// _Norm with avgop recomputed from the input, which the window keeps in cache,
+// in both of its consumers
+region_t* norm_stream(ts_t t_start, ts_t t_end, region_t* out, region_t* in)
+{
+    auto w = norm_stream_window;
+    auto vals = reinterpret_cast<float*>(in->data);
+    auto i = where_first(in, t_start);
+    if (i > get_end_idx(in)) {
+        return out;
+    }
+
+    bool prev = (get_end_time(out) == in->tl[i & in->mask].t);
+    for (auto t = (t_start / w + 1) * w; t - w < t_end; t += w) {
+        auto next = tumble_next(in, i, min(t, t_end));
+        if (next == i) {
+            continue;
+        }
+
+        float sum = 0, count = 0;
+        for (auto j = i; j < next; j++) {
+            if (in->tl[j & in->mask].d != 0) {
+                sum += vals[j & in->mask];
+                count += 1;
+            }
+        }
+        auto avg = sum / count;
+        float sq = 0;
+        for (auto j = i; j < next; j++) {
+            if (in->tl[j & in->mask].d != 0) {
+                auto d = vals[j & in->mask] - avg;
+                sq += d * d;
+            }
+        }
+        auto dev = sqrt(sq / count);
+        for (; i < next; i++) {
+            auto iv = in->tl[i & in->mask];
+            where_commit(out, iv, (vals[i & in->mask] - avg) / dev, iv.d != 0, prev);
+        }
+    }
+    return out;
+}
+
+class PanTomStreamBench : public FusionStats {
+public:
+    PanTomStreamBench(dur_t period, int64_t window, int64_t size) :
+        period(period), window(window), size(size)
+    {}
+
+    bool native() override { return true; }
+
+    // no TiLT query to compile, the kernel takes the place of the compiled code
+    intptr_t compile() override
+    {
+        if (window / period < 1) {
+            throw runtime_error("pantom_stream needs a window of at least one period");
+        }
+        return reinterpret_cast<intptr_t>(&pantom_stream);
+    }
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Fused kernels have no TiLT query");
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<float>(size);
+        out_reg = create_out_reg<float>(size, size);
+        stream.reset(new PanTomStream(period, window / period));
+        state_reg = {};
+        state_reg.data = reinterpret_cast<char*>(stream.get());
+
+        SynthData<float> dataset(period, size);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        run_query(addr, period * size, size, period, &out_reg, &in_reg, &state_reg);
+
+        // lp, hp and derv of one float and ma of two per event, each with its ival_t
+        auto in_entries = get_end_idx(&in_reg) - get_start_idx(&in_reg);
+        eliminated_bytes = in_entries * (3 * (sizeof(float) + sizeof(ival_t)) + sizeof(AvgState) + sizeof(ival_t));
+        ring_bytes = stream->bytes();
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_pantom(&in_reg, period, window));
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+        stream.reset();
+    }
+
+    dur_t period;
+    int64_t window;
+    int64_t size;
+    unique_ptr<PanTomStream> stream;
+    region_t in_reg;
+    region_t out_reg;
+    region_t state_reg;
+};
+
+class NormStreamBench : public FusionStats {
+public:
+    NormStreamBench(dur_t period, int64_t window, int64_t size) :
+        period(period), window(window), size(size)
+    {}
+
+    bool partitionable() override { return true; }
+
+    bool native() override { return true; }
+
+    intptr_t compile() override
+    {
+        norm_stream_window = window;
+        return reinterpret_cast<intptr_t>(&norm_stream);
+    }
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Fused kernels have no TiLT query");
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<float>(size);
+        out_reg = create_out_reg<float>(size, size);
+
+        SynthData<float> dataset(period, size);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        run_query(addr, period * size, size, window, &out_reg, &in_reg);
+
+        // avgop holds one float per event with its ival_t
+        auto in_entries = get_end_idx(&in_reg) - get_start_idx(&in_reg);
+        eliminated_bytes = in_entries * (sizeof(float) + sizeof(ival_t));
+        ring_bytes = 0;
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_norm(&in_reg, window));
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    dur_t period;
+    int64_t window;
+    int64_t size;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+// Runs testcase pantom_stream or normalize_stream, the fused kernels of the
+// compiled pantom and normalize, with the same parameters
+class ParallelFusionBench : public ParallelBenchmark {
+public:
+    ParallelFusionBench(int threads, const string& testcase, dur_t period, int64_t size)
+    {
+        for (int i = 0; i < threads; i++) {
+            if (testcase == "pantom_stream") {
+                benchs.push_back(new PanTomStreamBench(period, 30, size));
+            } else if (testcase == "normalize_stream") {
+                benchs.push_back(new NormStreamBench(period, 10000, size));
+            } else {
+                throw runtime_error("Invalid fused testcase " + testcase);
+            }
+        }
+    }
+
+    int64_t eliminated_bytes()
+    {
+        int64_t bytes = 0;
+        for (auto bench : benchs) {
+            bytes += static_cast<FusionStats*>(bench)->eliminated_bytes;
+        }
+        return bytes;
+    }
+
+    int64_t ring_bytes()
+    {
+        int64_t bytes = 0;
+        for (auto bench : benchs) {
+            bytes += static_cast<FusionStats*>(bench)->ring_bytes;
+        }
+        return bytes;
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_FUSE_H_
@@ -0,0 +1,461 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_IMPLICIT_H_
+#define TILT_BENCH_INCLUDE_TILT_IMPLICIT_H_
+
+#include <cstdlib>
+#include <vector>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+#include "tilt_compress.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Regions with implicit timelines.
+ *
+ * A region_t stores a 16 byte ival_t per event next to its payload. For
+ * periodic streams the timeline is fully described by (start, period, count)
+ * runs, so implicit_region_t keeps only the runs and a dense payload array.
+ * Near-periodic streams (missing events, changes of period) start a new run at
+ * every break. The TiLT code generator only reads explicit timelines, so the
+ * select / where / tumbling sum kernels below are native loops that compute
+ * timestamps arithmetically from the runs. The explicit_* kernels run the same
+ * loops natively over a region_t, the baseline the implicit ones compare to. */
+
+// `count` back to back events of length `period`, the k-th one spanning
+// (start + k * period, start + (k + 1) * period]
+struct run_t {
+    ts_t start;
+    dur_t period;
+    int64_t count;
+};
+
+// The payload of the i-th event overall lives at data + i * sizeof(T)
+struct implicit_region_t {
+    vector<run_t> runs;
+    int64_t count;
+    char* data;
+};
+
+template<typename T>
+implicit_region_t create_implicit_reg(int64_t size)
+{
+    implicit_region_t reg;
+    reg.count = 0;
+    reg.data = static_cast<char*>(malloc(size * sizeof(T)));
+    return reg;
+}
+
+void release_implicit_reg(implicit_region_t* reg)
+{
+    free(reg->data);
+}
+
+// Appends the event (st, st + d], extending the last run when the event
+// continues it. Returns the index of the event's payload.
+int64_t implicit_append(implicit_region_t* reg, ts_t st, dur_t d)
+{
+    if (!reg->runs.empty()) {
+        auto& last = reg->runs.back();
+        if (last.period == d && last.start + last.count * last.period == st) {
+            last.count++;
+            return reg->count++;
+        }
+    }
+    reg->runs.push_back(run_t{st, d, 1});
+    return reg->count++;
+}
+
+template<typename T>
+int64_t implicit_bytes(implicit_region_t* reg)
+{
+    return reg->runs.size() * sizeof(run_t) + reg->count * sizeof(T);
+}
+
+// Ingest-time conversion of an explicit region, dropping its null intervals
+template<typename T>
+void to_implicit(region_t* in, implicit_region_t* out)
+{
+    auto data = reinterpret_cast<T*>(out->data);
+    for (auto i = get_start_idx(in); i <= get_end_idx(in); i++) {
+        auto iv = in->tl[i & in->mask];
+        if (iv.d == 0) {
+            continue;
+        }
+        auto idx = implicit_append(out, iv.t, iv.d);
+        data[idx] = *reinterpret_cast<T*>(fetch(in, iv.t + iv.d, i, sizeof(T)));
+    }
+}
+
+// Explicit region of the events of `in`, with a null interval at every gap,
+// for checking an implicit output against the references
+template<typename T>
+void from_implicit(implicit_region_t* in, region_t* out)
+{
+    auto data = reinterpret_cast<T*>(in->data);
+    int64_t i = 0;
+    for (auto& r : in->runs) {
+        for (int64_t k = 0; k < r.count; k++, i++) {
+            auto st = r.start + k * r.period;
+            if (get_end_time(out) < st) {
+                commit_null(out, st);
+            }
+            commit_data(out, st + r.period);
+            *reinterpret_cast<T*>(fetch(out, st + r.period, get_end_idx(out), sizeof(T))) = data[i];
+        }
+    }
+}
+
+// The output has the timeline of the input, so the runs are shared and only
+// the payloads are touched
+template<typename T, typename F>
+void implicit_select(implicit_region_t* out, implicit_region_t* in, F op)
+{
+    auto in_data = reinterpret_cast<T*>(in->data);
+    auto out_data = reinterpret_cast<T*>(out->data);
+    out->runs = in->runs;
+    out->count = in->count;
+    for (int64_t i = 0; i < in->count; i++) {
+        out_data[i] = op(in_data[i]);
+    }
+}
+
+template<typename T, typename F>
+void implicit_where(implicit_region_t* out, implicit_region_t* in, F filter)
+{
+    auto in_data = reinterpret_cast<T*>(in->data);
+    auto out_data = reinterpret_cast<T*>(out->data);
+    int64_t i = 0;
+    for (auto& r : in->runs) {
+        for (int64_t k = 0; k < r.count; k++, i++) {
+            if (filter(in_data[i])) {
+                auto idx = implicit_append(out, r.start + k * r.period, r.period);
+                out_data[idx] = in_data[i];
+            }
+        }
+    }
+}
+
+// Sum over tumbling windows (n * w - w, n * w]. The events of a run falling
+// into one window are found arithmetically, so the inner loop is a plain sum
+// over the payload array. Only windows holding events produce an output.
+template<typename T>
+void implicit_window_sum(implicit_region_t* out, implicit_region_t* in, dur_t w)
+{
+    auto in_data = reinterpret_cast<T*>(in->data);
+    auto out_data = reinterpret_cast<T*>(out->data);
+    ts_t win = -1;
+    T sum = 0;
+    int64_t i = 0;
+    for (auto& r : in->runs) {
+        int64_t k = 0;
+        while (k < r.count) {
+            ts_t t = r.start + (k + 1) * r.period;
+            ts_t win_end = ((t + w - 1) / w) * w;
+            auto last = min((win_end - r.start) / r.period - 1, r.count - 1);
+
+            if (win_end != win) {
+                if (win >= 0) {
+                    out_data[implicit_append(out, win - w, w)] = sum;
+                }
+                win = win_end;
+                sum = 0;
+            }
+            for (auto j = i + k; j <= i + last; j++) {
+                sum += in_data[j];
+            }
+            k = last + 1;
+        }
+        i += r.count;
+    }
+    if (win >= 0) {
+        out_data[implicit_append(out, win - w, w)] = sum;
+    }
+}
+
+// Native versions of the kernels above over explicit timelines. Null intervals
+// of the input are skipped and gaps of the output get a null entry, as the
+// generated queries do.
+template<typename T, typename F>
+void explicit_select(region_t* out, region_t* in, F op)
+{
+    auto in_data = reinterpret_cast<T*>(in->data);
+    auto out_data = reinterpret_cast<T*>(out->data);
+    auto ei = out->ei;
+    for (auto i = get_start_idx(in) + 1; i <= get_end_idx(in); i++) {
+        auto p = i & in->mask;
+        auto o = ++ei & out->mask;
+        out->tl[o] = in->tl[p];
+        out_data[o] = op(in_data[p]);
+    }
+    out->ei = ei;
+}
+
+template<typename T, typename F>
+void explicit_where(region_t* out, region_t* in, F filter)
+{
+    auto in_data = reinterpret_cast<T*>(in->data);
+    auto out_data = reinterpret_cast<T*>(out->data);
+    auto ei = out->ei;
+    auto end = get_end_time(out);
+    for (auto i = get_start_idx(in) + 1; i <= get_end_idx(in); i++) {
+        auto p = i & in->mask;
+        auto iv = in->tl[p];
+        if (iv.d == 0 || !filter(in_data[p])) {
+            continue;
+        }
+        if (end != iv.t) {
+            out->tl[++ei & out->mask] = ival_t(iv.t, 0);
+        }
+        auto o = ++ei & out->mask;
+        out->tl[o] = iv;
+        out_data[o] = in_data[p];
+        end = iv.t + iv.d;
+    }
+    out->ei = ei;
+}
+
+template<typename T>
+void explicit_window_sum(region_t* out, region_t* in, dur_t w)
+{
+    auto in_data = reinterpret_cast<T*>(in->data);
+    auto out_data = reinterpret_cast<T*>(out->data);
+    auto ei = out->ei;
+    auto end = get_end_time(out);
+    auto emit = [&](ts_t win, T sum) {
+        if (end != win - w) {
+            out->tl[++ei & out->mask] = ival_t(win - w, 0);
+        }
+        auto o = ++ei & out->mask;
+        out->tl[o] = ival_t(win - w, w);
+        out_data[o] = sum;
+        end = win;
+    };
+    ts_t win = -1;
+    T sum = 0;
+    for (auto i = get_start_idx(in) + 1; i <= get_end_idx(in); i++) {
+        auto p = i & in->mask;
+        auto iv = in->tl[p];
+        if (iv.d == 0) {
+            continue;
+        }
+        ts_t t = iv.t + iv.d;
+        if (t > win) {
+            if (win >= 0) {
+                emit(win, sum);
+            }
+            win = ((t + w - 1) / w) * w;
+            sum = 0;
+        }
+        sum += in_data[p];
+    }
+    if (win >= 0) {
+        emit(win, sum);
+    }
+    out->ei = ei;
+}
+
+template<typename T>
+class ImplicitBench : public Benchmark {
+public:
+    ImplicitBench(CompOp op, dur_t period, int64_t w, int64_t size, double missing, int64_t burst) :
+        op(op), period(period), w(w), size(size), missing(missing), burst(burst)
+    {}
+
+    bool native() override { return true; }
+
+    intptr_t compile() override { return 0; }
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Implicit timeline benchmarks have no TiLT query");
+    }
+
+    void init() final
+    {
+        plain_reg = create_in_reg<T>(size);
+        SynthData<T> dataset(period, size, missing, burst);
+        dataset.fill(&plain_reg);
+
+        in_reg = create_implicit_reg<T>(size);
+        to_implicit<T>(&plain_reg, &in_reg);
+        // the reference needs the explicit input
+        if (!verify_output) {
+            release_reg(&plain_reg);
+        }
+
+        auto out_size = (op == CompOp::SUM) ? size / (w / period) + 2 : size;
+        out_reg = create_implicit_reg<T>(out_size);
+
+        // Runs of the output, sized here so that execute() never grows them:
+        // select copies the input runs, every kept event of where past a
+        // dropped one opens a run, and sum opens at most one per window
+        switch (op) {
+            case CompOp::SELECT:
+                out_reg.runs.reserve(in_reg.runs.size());
+                break;
+            case CompOp::WHERE:
+                out_reg.runs.reserve(in_reg.runs.size() + where_breaks());
+                break;
+            default:
+                out_reg.runs.reserve(out_size);
+                break;
+        }
+
+        input_bytes = implicit_bytes<T>(&in_reg);
+    }
+
+    void execute(intptr_t) final
+    {
+        switch (op) {
+            case CompOp::SELECT:
+                implicit_select<T>(&out_reg, &in_reg, [](T v) { return v + 3; });
+                break;
+            case CompOp::WHERE:
+                implicit_where<T>(&out_reg, &in_reg, [](T v) { return v > 0; });
+                break;
+            default:
+                implicit_window_sum<T>(&out_reg, &in_reg, w);
+                break;
+        }
+    }
+
+    Verdict verify() final
+    {
+        auto out = create_reg<T>(2 * out_reg.count + 1);
+        from_implicit<T>(&out_reg, &out);
+        auto res = ref_compare(&out, ref_comp<T>(&plain_reg, op, w));
+        release_reg(&out);
+        return res;
+    }
+
+    void release() final
+    {
+        if (verify_output) {
+            release_reg(&plain_reg);
+        }
+        release_implicit_reg(&in_reg);
+        release_implicit_reg(&out_reg);
+    }
+
+    int64_t where_breaks()
+    {
+        auto data = reinterpret_cast<T*>(in_reg.data);
+        int64_t breaks = 0;
+        for (int64_t i = 0; i < in_reg.count; i++) {
+            breaks += !(data[i] > 0);
+        }
+        return breaks;
+    }
+
+    CompOp op;
+    dur_t period;
+    int64_t w;
+    int64_t size;
+    double missing;
+    int64_t burst;
+    region_t plain_reg;
+    implicit_region_t in_reg;
+    implicit_region_t out_reg;
+};
+
+template<typename T>
+class ParallelImplicitBench : public ParallelBenchmark {
+public:
+    ParallelImplicitBench(int threads, CompOp op, dur_t period, int64_t w, int64_t size, double missing, int64_t burst)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new ImplicitBench<T>(op, period, w, size, missing, burst));
+        }
+    }
+};
+
+template<typename T>
+class ExplicitBench : public Benchmark {
+public:
+    ExplicitBench(CompOp op, dur_t period, int64_t w, int64_t size, double missing, int64_t burst) :
+        op(op), period(period), w(w), size(size), missing(missing), burst(burst)
+    {}
+
+    bool native() override { return true; }
+
+    intptr_t compile() override { return 0; }
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Explicit timeline baselines have no TiLT query");
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<T>(size);
+        SynthData<T> dataset(period, size, missing, burst);
+        dataset.fill(&in_reg);
+
+        // where may put a null entry before every kept event
+        switch (op) {
+            case CompOp::SELECT:
+                out_reg = create_reg<T>(size);
+                break;
+            case CompOp::WHERE:
+                out_reg = create_reg<T>(2 * size);
+                break;
+            default:
+                out_reg = create_reg<T>(2 * (size / (w / period) + 2));
+                break;
+        }
+
+        input_bytes = reg_bytes<T>(&in_reg);
+    }
+
+    void execute(intptr_t) final
+    {
+        switch (op) {
+            case CompOp::SELECT:
+                explicit_select<T>(&out_reg, &in_reg, [](T v) { return v + 3; });
+                break;
+            case CompOp::WHERE:
+                explicit_where<T>(&out_reg, &in_reg, [](T v) { return v > 0; });
+                break;
+            default:
+                explicit_window_sum<T>(&out_reg, &in_reg, w);
+                break;
+        }
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_comp<T>(&in_reg, op, w));
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    CompOp op;
+    dur_t period;
+    int64_t w;
+    int64_t size;
+    double missing;
+    int64_t burst;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+template<typename T>
+class ParallelExplicitBench : public ParallelBenchmark {
+public:
+    ParallelExplicitBench(int threads, CompOp op, dur_t period, int64_t w, int64_t size, double missing, int64_t burst)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new ExplicitBench<T>(op, period, w, size, missing, burst));
+        }
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_IMPLICIT_H_
@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_arena.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -53,10 +54,160 @@ Op _Impute(_sym in, int64_t window)
         fm_sym);
 }
 
+// Forward fill: carry the last present value across gaps
+Op _FFill(_sym in, int64_t p)
+{
+    auto out = _out(types::FLOAT32);
+
+    auto e = in[_pt(0)];
+    auto e_sym = _sym("e", e);
+    auto o = out[_pt(-p)];
+    auto o_sym = _sym("o", o);
+    auto res = _ifelse(_exists(e_sym), e_sym, o_sym);
+    auto res_sym = _sym("res", res);
+
+    return _op(
+        _iter(0, p),
+        Params{in},
+        SymTable{
+            {e_sym, e},
+            {o_sym, o},
+            {res_sym, res}
+        },
+        _exists(e_sym) || _exists(o_sym),
+        res_sym);
+}
+
+Op _ForwardFill(_sym in, int64_t p, int64_t scale)
+{
+    auto state = _sym("state", tilt::Type(types::FLOAT32, _iter(0, -1)));
+
+    auto win = in[_win(-p * scale, 0)];
+    auto win_sym = _sym("win", win);
+
+    auto ff = _FFill(win_sym, p);
+    auto ff_sym = _sym("ff", ff);
+
+    auto val = _f32(0);
+    auto val_sym = _sym("val", val);
+
+    auto sel = _Select(ff_sym, val_sym, [](_sym e, _sym val) { return e; });
+    auto sel_sym = _sym("sel", sel);
+
+    return _op(
+        _iter(0, p * scale),
+        Params{in, state},
+        SymTable{
+            {win_sym, win},
+            {ff_sym, ff},
+            {val_sym, val},
+            {sel_sym, sel}
+        },
+        _true(),
+        sel_sym,
+        Aux{
+            {ff_sym, state}
+        });
+}
+
+// {value, end time} of the first present event in the window
+Expr _First(_sym win)
+{
+    auto acc = [](Expr s, Expr st, Expr et, Expr d) {
+        auto found = _gt(_get(s, 1), _i64(0));
+        return _ifelse(found, s, _new(vector<Expr>{d, _cast(types::INT64, et)}));
+    };
+    return _red(win, _new(vector<Expr>{_f32(0), _i64(0)}), acc);
+}
+
+// {value, end time} of the last present event in the window
+Expr _Last(_sym win)
+{
+    auto acc = [](Expr s, Expr st, Expr et, Expr d) {
+        return _new(vector<Expr>{d, _cast(types::INT64, et)});
+    };
+    return _red(win, _new(vector<Expr>{_f32(0), _i64(0)}), acc);
+}
+
+// Backward fill: emits at t the value of slot t - horizon, taking the next
+// present value within `horizon` if the slot is empty. Longer gaps stay empty.
+Op _BackwardFill(_sym in, int64_t p, int64_t horizon)
+{
+    auto e = in[_pt(-horizon)];
+    auto e_sym = _sym("e", e);
+    auto ahead = in[_win(-horizon, 0)];
+    auto ahead_sym = _sym("ahead", ahead);
+
+    auto next = _First(ahead_sym);
+    auto next_sym = _sym("next", next);
+    auto next_found = _gt(_get(next_sym, 1), _i64(0));
+
+    auto res = _ifelse(_exists(e_sym), e_sym, _get(next_sym, 0));
+    auto res_sym = _sym("res", res);
+
+    return _op(
+        _iter(0, p),
+        Params{in},
+        SymTable{
+            {e_sym, e},
+            {ahead_sym, ahead},
+            {next_sym, next},
+            {res_sym, res}
+        },
+        _exists(e_sym) || next_found,
+        res_sym);
+}
+
+// Linear interpolation between the last present value before and the first
+// present value after slot t - horizon, each searched within `horizon`.
+Op _LinearInterp(_sym in, int64_t p, int64_t horizon)
+{
+    auto e = in[_pt(-horizon)];
+    auto e_sym = _sym("e", e);
+    auto behind = in[_win(-2 * horizon, -horizon)];
+    auto behind_sym = _sym("behind", behind);
+    auto ahead = in[_win(-horizon, 0)];
+    auto ahead_sym = _sym("ahead", ahead);
+
+    auto prev = _Last(behind_sym);
+    auto prev_sym = _sym("prev", prev);
+    auto next = _First(ahead_sym);
+    auto next_sym = _sym("next", next);
+
+    auto beat = _beat(_iter(0, p));
+    auto t = _cast(types::INT64, beat[_pt(0)]) - _i64(horizon);
+    auto t_sym = _sym("t", t);
+
+    auto pv = prev_sym << 0;
+    auto pt = prev_sym << 1;
+    auto nv = next_sym << 0;
+    auto nt = next_sym << 1;
+    auto frac = _cast(types::FLOAT32, t_sym - pt) / _cast(types::FLOAT32, nt - pt);
+    auto res = _ifelse(_exists(e_sym), e_sym, pv + ((nv - pv) * frac));
+    auto res_sym = _sym("res", res);
+
+    auto found = _gt(pt, _i64(0)) && _gt(nt, _i64(0));
+
+    return _op(
+        _iter(0, p),
+        Params{in, beat},
+        SymTable{
+            {e_sym, e},
+            {behind_sym, behind},
+            {ahead_sym, ahead},
+            {prev_sym, prev},
+            {next_sym, next},
+            {t_sym, t},
+            {res_sym, res}
+        },
+        _exists(e_sym) || found,
+        res_sym);
+}
+
 class ImputeBench : public Benchmark {
 public:
-    ImputeBench(dur_t period, int64_t window, int64_t size) :
-        period(period), window(window), size(size)
+    ImputeBench(dur_t period, int64_t window, int64_t size, double missing, int64_t burst) :
+        period(period), window(window), size(size), missing(missing), burst(burst)
     {}
 
 private:
@@ -68,10 +219,10 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         out_reg = create_reg<float>(size);
 
-        SynthData<float> dataset(period, size);
+        SynthData<float> dataset(period, size, missing, burst);
         dataset.fill(&in_reg);
     }
 
@@ -81,8 +232,17 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_fillmean(&in_reg, period, window, size));
+    }
+
     void release() final
     {
+#ifdef _PRINT_REGION_
+        print_reg<float>(&in_reg, "fillmean_in_reg.txt");
+        print_reg<float>(&out_reg, "fillmean_out_reg.txt");
+#endif
         release_reg(&in_reg);
         release_reg(&out_reg);
     }
@@ -90,16 +250,207 @@ private:
     int64_t window;
     dur_t period;
     int64_t size;
+    double missing;
+    int64_t burst;
     region_t in_reg;
     region_t out_reg;
 };
 
 class ParallelImputeBench : public ParallelBenchmark {
 public:
-    ParallelImputeBench(int threads, dur_t period, int64_t window, int64_t size)
+    ParallelImputeBench(int threads, dur_t period, int64_t window, int64_t size, double missing, int64_t burst)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new ImputeBench(period, window, size, missing, burst));
+        }
+    }
+};
+
+class FFillBench : public Benchmark {
+public:
+    FFillBench(dur_t period, int64_t scale, int64_t size, double missing, int64_t burst) :
+        period(period), scale(scale), size(size), missing(missing), burst(burst)
+    {}
+
+private:
+    Op query() final
+    {
+        auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        return _ForwardFill(in_sym, period, scale);
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<float>(size);
+        state_reg = RegionArena::Get(part)->state<float>(scale, query(), 1);
+        out_reg = create_reg<float>(size);
+
+        SynthData<float> dataset(period, size, missing, burst);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr;
+        query(0, period * size, &out_reg, &in_reg, state_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_ffill(&in_reg, period, size));
+    }
+
+    void release() final
+    {
+#ifdef _PRINT_REGION_
+        print_reg<float>(&in_reg, "ffill_in_reg.txt");
+        print_reg<float>(&out_reg, "ffill_out_reg.txt");
+#endif
+        release_reg(&in_reg);
+        RegionArena::Get(part)->reset();
+        release_reg(&out_reg);
+    }
+
+    dur_t period;
+    int64_t scale;
+    int64_t size;
+    double missing;
+    int64_t burst;
+    region_t in_reg;
+    region_t* state_reg;
+    region_t out_reg;
+};
+
+class ParallelFFillBench : public ParallelBenchmark {
+public:
+    ParallelFFillBench(int threads, dur_t period, int64_t scale, int64_t size, double missing, int64_t burst)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new FFillBench(period, scale, size, missing, burst));
+        }
+    }
+};
+
+class BFillBench : public Benchmark {
+public:
+    BFillBench(dur_t period, int64_t horizon, int64_t size, double missing, int64_t burst) :
+        period(period), horizon(horizon), size(size), missing(missing), burst(burst)
+    {}
+
+private:
+    Op query() final
+    {
+        auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        return _BackwardFill(in_sym, period, horizon);
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<float>(size);
+        out_reg = create_reg<float>(size);
+
+        SynthData<float> dataset(period, size, missing, burst);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
+        query(0, period * size, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_bfill(&in_reg, period, horizon, size));
+    }
+
+    void release() final
+    {
+#ifdef _PRINT_REGION_
+        print_reg<float>(&in_reg, "bfill_in_reg.txt");
+        print_reg<float>(&out_reg, "bfill_out_reg.txt");
+#endif
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    dur_t period;
+    int64_t horizon;
+    int64_t size;
+    double missing;
+    int64_t burst;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+class ParallelBFillBench : public ParallelBenchmark {
+public:
+    ParallelBFillBench(int threads, dur_t period, int64_t horizon, int64_t size, double missing, int64_t burst)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new BFillBench(period, horizon, size, missing, burst));
+        }
+    }
+};
+
+class InterpBench : public Benchmark {
+public:
+    InterpBench(dur_t period, int64_t horizon, int64_t size, double missing, int64_t burst) :
+        period(period), horizon(horizon), size(size), missing(missing), burst(burst)
+    {}
+
+private:
+    Op query() final
+    {
+        auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        return _LinearInterp(in_sym, period, horizon);
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<float>(size);
+        out_reg = create_reg<float>(size);
+
+        SynthData<float> dataset(period, size, missing, burst);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
+        query(0, period * size, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_interp(&in_reg, period, horizon, size));
+    }
+
+    void release() final
+    {
+#ifdef _PRINT_REGION_
+        print_reg<float>(&in_reg, "interp_in_reg.txt");
+        print_reg<float>(&out_reg, "interp_out_reg.txt");
+#endif
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    dur_t period;
+    int64_t horizon;
+    int64_t size;
+    double missing;
+    int64_t burst;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+class ParallelInterpBench : public ParallelBenchmark {
+public:
+    ParallelInterpBench(int threads, dur_t period, int64_t horizon, int64_t size, double missing, int64_t burst)
     {
         for (int i = 0; i < threads; i++) {
-            benchs.push_back(new ImputeBench(period, window, size));
+            benchs.push_back(new InterpBench(period, horizon, size, missing, burst));
         }
     }
 };
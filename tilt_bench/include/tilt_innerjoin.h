@@ -16,6 +16,8 @@ public:
         lperiod(lperiod), rperiod(rperiod), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -26,11 +28,11 @@ private:
 
     void init() final
     {
-        left_reg = create_reg<int64_t>(size);
-        right_reg = create_reg<int64_t>(size);
+        left_reg = create_in_reg<int64_t>(size);
+        right_reg = create_in_reg<int64_t>(size);
         float ratio = (float) max(lperiod, rperiod) / (float) min(lperiod, rperiod);
         int osize = size * ceil(ratio);
-        out_reg = create_reg<int64_t>(osize);
+        out_reg = create_out_reg<int64_t>(osize, size);
 
         SynthData<int64_t> dataset_left(lperiod, size);
         dataset_left.fill(&left_reg);
@@ -40,8 +42,13 @@ private:
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr;
-        query(0, min(lperiod, rperiod) * size, &out_reg, &left_reg, &right_reg);
+        run_query(addr, min(lperiod, rperiod) * size, size, 1, &out_reg, &left_reg, &right_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_join<int64_t>(&left_reg, &right_reg,
+            [](int64_t l, int64_t r) { return l + r; }));
     }
 
     void release() final
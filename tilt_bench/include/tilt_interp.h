@@ -0,0 +1,725 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_INTERP_H_
+#define TILT_BENCH_INCLUDE_TILT_INTERP_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tilt/builder/tilder.h"
+
+using namespace std;
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Interpreter of the query graph.
+ *
+ * Tier 0 of tiered mode (tilt_tier.h) for every query without a native
+ * baseline. It walks the Op/Expr graph that LoopGen would lower instead of
+ * generating code, with the semantics of the generated loops: an operation
+ * steps through the slice on its iteration period, evaluates its symbols at
+ * every point and emits its output over the period when the predicate holds.
+ * Input streams are read in place from their regions, a window is a view of
+ * its stream, and a nested operation runs over the period of the enclosing
+ * one and commits its output to its Aux region, where later periods read it. Values are boxed and every
+ * node is dispatched at run time, so it is slow, but it starts at once.
+ *
+ * The graph is walked once in the constructor, which builds the accumulator
+ * of every reduction, and is only read afterwards, so the partitions of a
+ * query share one interpreter. */
+
+// A boxed value: integers, bools and times in `i`, floats in `f` and struct
+// fields in `fields`. Invalid if the value does not exist.
+struct IVal {
+    bool valid = false;
+    int64_t i = 0;
+    double f = 0;
+    vector<IVal> fields;
+};
+
+// Multiple of `p` plus `o` ending the period of `p` that covers `t`
+inline ts_t interp_ceil(ts_t t, dur_t p, ts_t o)
+{
+    auto k = t - o;
+    return (k >= 0 ? (k + p - 1) / p : k / p) * p + o;
+}
+
+inline bool interp_struct(const DataType& dt) { return !dt.dtypes.empty(); }
+
+inline bool interp_float(const DataType& dt)
+{
+    return dt.btype == BaseType::FLOAT32 || dt.btype == BaseType::FLOAT64;
+}
+
+// Bytes and alignment of a payload, structs laid out as the generated code does
+inline size_t interp_align(const DataType& dt);
+
+inline size_t interp_size(const DataType& dt)
+{
+    if (!interp_struct(dt)) {
+        switch (dt.btype) {
+            case BaseType::BOOL:
+            case BaseType::INT8:
+            case BaseType::UINT8:
+                return 1;
+            case BaseType::INT16:
+            case BaseType::UINT16:
+                return 2;
+            case BaseType::INT32:
+            case BaseType::UINT32:
+            case BaseType::FLOAT32:
+                return 4;
+            default:
+                return 8;
+        }
+    }
+    size_t size = 0;
+    for (auto& field : dt.dtypes) {
+        auto align = interp_align(field);
+        size = (size + align - 1) / align * align + interp_size(field);
+    }
+    auto align = interp_align(dt);
+    return (size + align - 1) / align * align;
+}
+
+inline size_t interp_align(const DataType& dt)
+{
+    if (!interp_struct(dt)) {
+        return interp_size(dt);
+    }
+    size_t align = 1;
+    for (auto& field : dt.dtypes) {
+        align = max(align, interp_align(field));
+    }
+    return align;
+}
+
+// `v` truncated to the range of `dt`, as the generated code would hold it
+inline IVal interp_wrap(IVal v, const DataType& dt)
+{
+    switch (dt.btype) {
+        case BaseType::BOOL: v.i = (v.i != 0); break;
+        case BaseType::INT8: v.i = (int8_t) v.i; break;
+        case BaseType::INT16: v.i = (int16_t) v.i; break;
+        case BaseType::INT32: v.i = (int32_t) v.i; break;
+        case BaseType::UINT8: v.i = (uint8_t) v.i; break;
+        case BaseType::UINT16: v.i = (uint16_t) v.i; break;
+        case BaseType::UINT32: v.i = (uint32_t) v.i; break;
+        case BaseType::FLOAT32: v.f = (float) v.f; break;
+        default: break;
+    }
+    return v;
+}
+
+// `v` of type `from` converted to `to`
+inline IVal interp_cast(IVal v, const DataType& from, const DataType& to)
+{
+    if (interp_struct(to)) {
+        return v;
+    }
+    if (interp_float(from) && !interp_float(to)) {
+        v.i = (int64_t) v.f;
+    } else if (!interp_float(from) && interp_float(to)) {
+        v.f = (from.btype == BaseType::UINT64) ? (double) (uint64_t) v.i : (double) v.i;
+    }
+    return interp_wrap(v, to);
+}
+
+inline IVal interp_read(const DataType& dt, const char* ptr)
+{
+    IVal v;
+    v.valid = true;
+    if (interp_struct(dt)) {
+        size_t off = 0;
+        for (auto& field : dt.dtypes) {
+            auto align = interp_align(field);
+            off = (off + align - 1) / align * align;
+            v.fields.push_back(interp_read(field, ptr + off));
+            off += interp_size(field);
+        }
+        return v;
+    }
+    switch (dt.btype) {
+        case BaseType::BOOL:
+        case BaseType::UINT8: v.i = *reinterpret_cast<const uint8_t*>(ptr); break;
+        case BaseType::INT8: v.i = *reinterpret_cast<const int8_t*>(ptr); break;
+        case BaseType::INT16: v.i = *reinterpret_cast<const int16_t*>(ptr); break;
+        case BaseType::UINT16: v.i = *reinterpret_cast<const uint16_t*>(ptr); break;
+        case BaseType::INT32: v.i = *reinterpret_cast<const int32_t*>(ptr); break;
+        case BaseType::UINT32: v.i = *reinterpret_cast<const uint32_t*>(ptr); break;
+        case BaseType::FLOAT32: v.f = *reinterpret_cast<const float*>(ptr); break;
+        case BaseType::FLOAT64: v.f = *reinterpret_cast<const double*>(ptr); break;
+        default: v.i = *reinterpret_cast<const int64_t*>(ptr); break;
+    }
+    return v;
+}
+
+inline void interp_write(const DataType& dt, const IVal& v, char* ptr)
+{
+    if (interp_struct(dt)) {
+        size_t off = 0;
+        for (size_t k = 0; k < dt.dtypes.size(); k++) {
+            auto& field = dt.dtypes[k];
+            auto align = interp_align(field);
+            off = (off + align - 1) / align * align;
+            interp_write(field, v.fields[k], ptr + off);
+            off += interp_size(field);
+        }
+        return;
+    }
+    switch (dt.btype) {
+        case BaseType::BOOL:
+        case BaseType::UINT8:
+        case BaseType::INT8: *reinterpret_cast<int8_t*>(ptr) = v.i; break;
+        case BaseType::INT16:
+        case BaseType::UINT16: *reinterpret_cast<int16_t*>(ptr) = v.i; break;
+        case BaseType::INT32:
+        case BaseType::UINT32: *reinterpret_cast<int32_t*>(ptr) = v.i; break;
+        case BaseType::FLOAT32: *reinterpret_cast<float*>(ptr) = v.f; break;
+        case BaseType::FLOAT64: *reinterpret_cast<double*>(ptr) = v.f; break;
+        default: *reinterpret_cast<int64_t*>(ptr) = v.i; break;
+    }
+}
+
+struct IEvent {
+    ts_t st;
+    ts_t et;
+    IVal v;
+};
+
+// A stream: the events of a region followed by the events the interpreter
+// made, or a beat, seen through the window (lo, hi]
+struct IStream {
+    const DataType* dt = nullptr;
+    region_t* reg = nullptr;
+    shared_ptr<vector<IEvent>> evs;
+    dur_t beat = 0;
+    ts_t beat_off = 0;
+    ts_t lo = numeric_limits<ts_t>::min();
+    ts_t hi = numeric_limits<ts_t>::max();
+
+    IStream view(ts_t a, ts_t b) const
+    {
+        auto s = *this;
+        s.lo = max(lo, a);
+        s.hi = min(hi, b);
+        return s;
+    }
+
+    // First region entry ending at or after `t`, among the entries still in
+    // the ring of a state region that wrapped
+    idx_t reg_find(ts_t t) const
+    {
+        auto lo_i = max(get_start_idx(reg), get_end_idx(reg) - reg->mask), hi_i = get_end_idx(reg) + 1;
+        while (lo_i < hi_i) {
+            auto mid = lo_i + (hi_i - lo_i) / 2;
+            auto& iv = reg->tl[mid & reg->mask];
+            if (iv.t + iv.d < t) {
+                lo_i = mid + 1;
+            } else {
+                hi_i = mid;
+            }
+        }
+        return lo_i;
+    }
+
+    // First made event ending at or after `t`
+    size_t evs_find(ts_t t) const
+    {
+        return lower_bound(evs->begin(), evs->end(), t,
+            [](const IEvent& e, ts_t t) { return e.et < t; }) - evs->begin();
+    }
+
+    IVal reg_val(idx_t i) const
+    {
+        auto& iv = reg->tl[i & reg->mask];
+        return interp_read(*dt, fetch(reg, iv.t + iv.d, i, interp_size(*dt)));
+    }
+
+    // Value of the event covering `t`, invalid if there is none
+    IVal at(ts_t t) const
+    {
+        IVal none;
+        if (t <= lo || t > hi) {
+            return none;
+        }
+        if (beat) {
+            IVal v;
+            v.valid = true;
+            v.i = interp_ceil(t, beat, beat_off);
+            return v;
+        }
+        if (evs && !evs->empty() && t > evs->front().st) {
+            auto k = evs_find(t);
+            if (k < evs->size() && (*evs)[k].st < t) {
+                return (*evs)[k].v;
+            }
+            return none;
+        }
+        if (reg) {
+            auto i = reg_find(t);
+            if (i <= get_end_idx(reg)) {
+                auto& iv = reg->tl[i & reg->mask];
+                if (iv.d > 0 && iv.t < t) {
+                    return reg_val(i);
+                }
+            }
+        }
+        return none;
+    }
+
+    // Calls `f(st, et, value)` on every event overlapping the window, in order
+    template<typename F>
+    void each(F f) const
+    {
+        if (beat) {
+            for (auto t = interp_ceil(lo + 1, beat, beat_off); t - beat < hi; t += beat) {
+                IVal v;
+                v.valid = true;
+                v.i = t;
+                f(t - beat, t, v);
+            }
+            return;
+        }
+        if (reg) {
+            auto end = get_end_idx(reg);
+            for (auto i = reg_find(lo + 1); i <= end; i++) {
+                auto& iv = reg->tl[i & reg->mask];
+                if (iv.t >= hi) {
+                    return;
+                }
+                if (iv.d > 0) {
+                    f(iv.t, iv.t + iv.d, reg_val(i));
+                }
+            }
+        }
+        if (evs) {
+            for (auto k = evs_find(lo + 1); k < evs->size() && (*evs)[k].st < hi; k++) {
+                auto& e = (*evs)[k];
+                f(e.st, e.et, e.v);
+            }
+        }
+    }
+
+    bool empty() const
+    {
+        bool none = true;
+        each([&none](ts_t, ts_t, const IVal&) { none = false; });
+        return none;
+    }
+};
+
+// Commits `evs` to `reg`, with a null before every gap
+inline void interp_commit(region_t* reg, const vector<IEvent>& evs, const DataType& dt)
+{
+    auto size = interp_size(dt);
+    for (auto& e : evs) {
+        if (get_end_time(reg) < e.st) {
+            commit_null(reg, e.st);
+        }
+        commit_data(reg, e.et);
+        interp_write(dt, e.v, fetch(reg, e.et, get_end_idx(reg), size));
+    }
+}
+
+class Interpreter {
+public:
+    explicit Interpreter(Op query_op) : query_op(query_op)
+    {
+        prepare(query_op);
+    }
+
+    size_t arity() const { return query_op->inputs.size(); }
+
+    // Runs the query over (ts, te], same as the compiled code
+    region_t* run(ts_t ts, ts_t te, region_t* out, const vector<region_t*>& ins) const
+    {
+        auto op = query_op.get();
+        vector<Res> args(ins.size());
+        for (size_t k = 0; k < ins.size(); k++) {
+            args[k].stream = true;
+            args[k].s.dt = &op->inputs[k]->type.dtype;
+            args[k].s.reg = ins[k];
+        }
+        IStream res;
+        res.dt = &op->type.dtype;
+        res.reg = out;
+        res.evs = make_shared<vector<IEvent>>();
+        run_op(op, nullptr, args, ts, te, res);
+        interp_commit(out, *res.evs, *res.dt);
+        return out;
+    }
+
+private:
+    // Result of an expression, a value or a stream
+    struct Res {
+        bool stream = false;
+        IVal v;
+        IStream s;
+    };
+
+    // Evaluation of an operation at one point, or of one step of a reduction
+    struct Frame {
+        const OpNode* op = nullptr;
+        const Frame* up = nullptr;
+        ts_t t = 0;
+        const map<const ExprNode*, Res>* bound = nullptr;
+        mutable unordered_map<const ExprNode*, Res> memo;
+        const IStream* out = nullptr;
+    };
+
+    // Accumulator of a reduction applied to placeholder symbols
+    struct Acc {
+        Sym s, st, et, d;
+        Expr body;
+    };
+
+    // Indexes the symbols of every operation and builds the accumulators
+    void prepare(const Expr& e)
+    {
+        // tilder overloads ! on expressions, so the null check is spelled out
+        if (e == nullptr || !seen.insert(e.get()).second) {
+            return;
+        }
+        if (auto op = dynamic_pointer_cast<OpNode>(e)) {
+            auto& table = defs[op.get()];
+            for (auto& entry : op->syms) {
+                table[entry.first.get()] = entry.second;
+                prepare(entry.second);
+            }
+            for (auto& entry : op->aux) {
+                aux[op.get()][entry.first.get()] = entry.second;
+            }
+            prepare(op->pred);
+        } else if (auto red = dynamic_pointer_cast<Reduce>(e)) {
+            Acc acc;
+            acc.s = _sym("s", red->state);
+            acc.st = _sym("st", _i64(0));
+            acc.et = _sym("et", _i64(0));
+            acc.d = _sym("d", tilt::Type(red->lstream->type.dtype));
+            acc.body = red->acc(acc.s, acc.st, acc.et, acc.d);
+            accs[red.get()] = acc;
+            prepare(red->state);
+            prepare(acc.body);
+        } else if (auto nary = dynamic_pointer_cast<NaryExpr>(e)) {
+            for (auto& arg : nary->args) {
+                prepare(arg);
+            }
+        } else if (auto ifelse = dynamic_pointer_cast<IfElse>(e)) {
+            prepare(ifelse->cond);
+            prepare(ifelse->true_body);
+            prepare(ifelse->false_body);
+        } else if (auto sel = dynamic_pointer_cast<Select>(e)) {
+            prepare(sel->cond);
+            prepare(sel->true_body);
+            prepare(sel->false_body);
+        } else if (auto cast = dynamic_pointer_cast<Cast>(e)) {
+            prepare(cast->arg);
+        } else if (auto get = dynamic_pointer_cast<Get>(e)) {
+            prepare(get->input);
+        } else if (auto nw = dynamic_pointer_cast<New>(e)) {
+            for (auto& input : nw->inputs) {
+                prepare(input);
+            }
+        }
+    }
+
+    // Points of `op` in (ts, te] aligned to its period, each with the output
+    // over the period ending at it appended to `out`
+    void run_op(const OpNode* op, const Frame* up, const vector<Res>& args, ts_t ts, ts_t te, IStream& out) const
+    {
+        map<const ExprNode*, Res> bound;
+        for (size_t k = 0; k < args.size(); k++) {
+            bound[op->inputs[k].get()] = args[k];
+        }
+        auto p = op->iter.period;
+
+        Frame f;
+        f.op = op;
+        f.up = up;
+        f.bound = &bound;
+        f.out = &out;
+        for (auto t = interp_ceil(ts + 1, p, op->iter.offset); t <= te; t += p) {
+            f.t = t;
+            f.memo.clear();
+            auto pred = val(op->pred, f);
+            if (!pred.valid || !pred.i) {
+                continue;
+            }
+            auto res = lookup(op->output.get(), f);
+            if (res.stream) {
+                res.s.view(t - p, t).each([&out](ts_t st, ts_t et, const IVal& v) {
+                    out.evs->push_back(IEvent{st, et, v});
+                });
+            } else if (res.v.valid) {
+                out.evs->push_back(IEvent{t - p, t, res.v});
+            }
+        }
+    }
+
+    // Output of the operation `sym` is defined as, over the period of `f`
+    Res nested(const OpNode* sub, const Symbol* sym, const Frame& f) const
+    {
+        vector<Res> args;
+        for (auto& input : sub->inputs) {
+            args.push_back(lookup(input.get(), f));
+        }
+        IStream out;
+        out.dt = &sub->type.dtype;
+        out.evs = make_shared<vector<IEvent>>();
+        auto op_aux = aux.find(f.op);
+        if (op_aux != aux.end() && op_aux->second.count(sym)) {
+            out.reg = lookup(op_aux->second.at(sym).get(), f).s.reg;
+        }
+        run_op(sub, &f, args, f.t - f.op->iter.period, f.t, out);
+        Res res;
+        res.stream = true;
+        res.s.dt = out.dt;
+        // readers of an Aux state see its past periods too, as in the
+        // compiled code reading the state region
+        if (out.reg) {
+            interp_commit(out.reg, *out.evs, *out.dt);
+            res.s.reg = out.reg;
+        } else {
+            res.s.evs = out.evs;
+        }
+        return res;
+    }
+
+    Res lookup(const Symbol* sym, const Frame& f) const
+    {
+        for (auto fr = &f; fr; fr = fr->up) {
+            if (fr->bound) {
+                auto it = fr->bound->find(sym);
+                if (it != fr->bound->end()) {
+                    return it->second;
+                }
+            }
+            if (fr->op) {
+                auto memo = fr->memo.find(sym);
+                if (memo != fr->memo.end()) {
+                    return memo->second;
+                }
+                auto& table = defs.at(fr->op);
+                auto def = table.find(sym);
+                if (def != table.end()) {
+                    auto res = eval(def->second, sym, *fr);
+                    fr->memo[sym] = res;
+                    return res;
+                }
+            }
+            if (fr->out && dynamic_cast<const Out*>(sym)) {
+                Res res;
+                res.stream = true;
+                res.s = *fr->out;
+                return res;
+            }
+        }
+        if (sym->type.iter.period > 0) {
+            Res res;
+            res.stream = true;
+            res.s.beat = sym->type.iter.period;
+            res.s.beat_off = sym->type.iter.offset;
+            return res;
+        }
+        throw runtime_error("Interpreter: unbound symbol " + sym->name);
+    }
+
+    // Result of the definition `e` of `sym`
+    Res eval(const Expr& e, const Symbol* sym, const Frame& f) const
+    {
+        auto node = e.get();
+        Res res;
+        if (auto sub = dynamic_cast<const OpNode*>(node)) {
+            return nested(sub, sym, f);
+        } else if (auto subls = dynamic_cast<const SubLStream*>(node)) {
+            auto base = lookup(subls->lstream.get(), f);
+            res.stream = true;
+            res.s = base.s.view(f.t + subls->win.start.offset, f.t + subls->win.end.offset);
+            return res;
+        } else if (auto other = dynamic_cast<const Symbol*>(node)) {
+            return lookup(other, f);
+        }
+        res.v = val(e, f);
+        return res;
+    }
+
+    IVal val(const Expr& e, const Frame& f) const
+    {
+        auto node = e.get();
+        if (auto sym = dynamic_cast<const Symbol*>(node)) {
+            auto res = lookup(sym, f);
+            if (res.stream) {
+                throw runtime_error("Interpreter: stream " + sym->name + " used as a value");
+            }
+            return res.v;
+        } else if (auto elem = dynamic_cast<const Element*>(node)) {
+            return lookup(elem->lstream.get(), f).s.at(f.t + elem->pt.offset);
+        } else if (auto nary = dynamic_cast<const NaryExpr*>(node)) {
+            return math(nary, f);
+        } else if (auto c = dynamic_cast<const ConstNode*>(node)) {
+            IVal v;
+            v.valid = true;
+            v.i = (int64_t) c->val;
+            v.f = c->val;
+            return interp_wrap(v, c->type.dtype);
+        } else if (auto get = dynamic_cast<const Get*>(node)) {
+            auto v = val(get->input, f);
+            return v.valid ? v.fields[get->n] : IVal();
+        } else if (auto nw = dynamic_cast<const New*>(node)) {
+            IVal v;
+            v.valid = true;
+            for (auto& input : nw->inputs) {
+                v.fields.push_back(val(input, f));
+                v.valid = v.valid && v.fields.back().valid;
+            }
+            return v;
+        } else if (auto exists = dynamic_cast<const Exists*>(node)) {
+            auto res = lookup(exists->sym.get(), f);
+            IVal v;
+            v.valid = true;
+            v.i = res.stream ? !res.s.empty() : res.v.valid;
+            return v;
+        } else if (auto ifelse = dynamic_cast<const IfElse*>(node)) {
+            auto cond = val(ifelse->cond, f);
+            if (!cond.valid) {
+                return IVal();
+            }
+            return val(cond.i ? ifelse->true_body : ifelse->false_body, f);
+        } else if (auto sel = dynamic_cast<const Select*>(node)) {
+            auto cond = val(sel->cond, f);
+            if (!cond.valid) {
+                return IVal();
+            }
+            return val(cond.i ? sel->true_body : sel->false_body, f);
+        } else if (auto cast = dynamic_cast<const Cast*>(node)) {
+            auto v = val(cast->arg, f);
+            return v.valid ? interp_cast(v, cast->arg->type.dtype, cast->type.dtype) : v;
+        } else if (auto red = dynamic_cast<const Reduce*>(node)) {
+            return reduce(red, f);
+        }
+        throw runtime_error("Interpreter: unsupported expression");
+    }
+
+    // Folds the accumulator over the events of the reduced stream
+    IVal reduce(const Reduce* red, const Frame& f) const
+    {
+        auto& acc = accs.at(red);
+        auto state = val(red->state, f);
+        auto stream = lookup(red->lstream.get(), f).s;
+        map<const ExprNode*, Res> bound;
+        Frame rf;
+        rf.up = &f;
+        rf.t = f.t;
+        rf.bound = &bound;
+        stream.each([&](ts_t st, ts_t et, const IVal& v) {
+            bound[acc.s.get()].v = state;
+            bound[acc.st.get()].v.valid = true;
+            bound[acc.st.get()].v.i = st;
+            bound[acc.et.get()].v.valid = true;
+            bound[acc.et.get()].v.i = et;
+            bound[acc.d.get()].v = v;
+            state = val(acc.body, rf);
+        });
+        return state;
+    }
+
+    IVal math(const NaryExpr* nary, const Frame& f) const
+    {
+        IVal v;
+        v.valid = true;
+        auto& args = nary->args;
+        if (nary->op == MathOp::AND || nary->op == MathOp::OR) {
+            auto a = val(args[0], f);
+            if (a.valid && a.i == (nary->op == MathOp::OR)) {
+                return a;
+            }
+            auto b = val(args[1], f);
+            if (!a.valid || !b.valid) {
+                return IVal();
+            }
+            v.i = b.i;
+            return v;
+        }
+
+        // operands of another type are converted to the type of the first one
+        auto& dt = args[0]->type.dtype;
+        vector<IVal> in;
+        for (auto& arg : args) {
+            in.push_back(val(arg, f));
+            if (!in.back().valid) {
+                return IVal();
+            }
+            if (arg->type.dtype.btype != dt.btype) {
+                in.back() = interp_cast(in.back(), arg->type.dtype, dt);
+            }
+        }
+        bool fp = interp_float(dt);
+        auto& a = in[0];
+        auto& b = in.size() > 1 ? in[1] : in[0];
+        switch (nary->op) {
+            case MathOp::ADD: v.f = a.f + b.f; v.i = a.i + b.i; break;
+            case MathOp::SUB: v.f = a.f - b.f; v.i = a.i - b.i; break;
+            case MathOp::MUL: v.f = a.f * b.f; v.i = a.i * b.i; break;
+            case MathOp::DIV: v.f = a.f / b.f; v.i = b.i ? a.i / b.i : 0; break;
+            case MathOp::MOD: v.f = fmod(a.f, b.f); v.i = b.i ? a.i % b.i : 0; break;
+            case MathOp::MAX: v.f = max(a.f, b.f); v.i = max(a.i, b.i); break;
+            case MathOp::MIN: v.f = min(a.f, b.f); v.i = min(a.i, b.i); break;
+            case MathOp::ABS: v.f = fabs(a.f); v.i = a.i < 0 ? -a.i : a.i; break;
+            case MathOp::NEG: v.f = -a.f; v.i = -a.i; break;
+            case MathOp::SQRT: v.f = sqrt(fp ? a.f : (double) a.i); break;
+            case MathOp::POW: v.f = pow(fp ? a.f : (double) a.i, fp ? b.f : (double) b.i); break;
+            case MathOp::CEIL: v.f = ceil(a.f); v.i = a.i; break;
+            case MathOp::FLOOR: v.f = floor(a.f); v.i = a.i; break;
+            case MathOp::EQ: v.i = fp ? a.f == b.f : a.i == b.i; break;
+            case MathOp::LT: v.i = fp ? a.f < b.f : a.i < b.i; break;
+            case MathOp::LTE: v.i = fp ? a.f <= b.f : a.i <= b.i; break;
+            case MathOp::GT: v.i = fp ? a.f > b.f : a.i > b.i; break;
+            case MathOp::GTE: v.i = fp ? a.f >= b.f : a.i >= b.i; break;
+            case MathOp::NOT: v.i = !a.i; break;
+            default: throw runtime_error("Interpreter: unsupported operator");
+        }
+        return interp_wrap(v, nary->type.dtype);
+    }
+
+    Op query_op;
+    set<const ExprNode*> seen;
+    map<const OpNode*, unordered_map<const ExprNode*, Expr>> defs;
+    map<const OpNode*, map<const ExprNode*, Sym>> aux;
+    map<const Reduce*, Acc> accs;
+};
+
+// Interpreter of the query tier 0 runs, set by Benchmark::tier0() before the
+// partitions start and kept until the next run replaces it
+inline unique_ptr<Interpreter> tier0_interp;
+
+// Entry point with the signature of a compiled query of sizeof...(Regs) inputs
+template<typename... Regs>
+region_t* interp_query(ts_t ts, ts_t te, region_t* out, Regs*... ins)
+{
+    return tier0_interp->run(ts, te, out, vector<region_t*>{ins...});
+}
+
+// Starts interpreting `query_op`, returns the entry point of its arity
+inline intptr_t interp_compile(Op query_op)
+{
+    tier0_interp.reset(new Interpreter(query_op));
+    switch (tier0_interp->arity()) {
+        case 1: return reinterpret_cast<intptr_t>(&interp_query<region_t>);
+        case 2: return reinterpret_cast<intptr_t>(&interp_query<region_t, region_t>);
+        case 3: return reinterpret_cast<intptr_t>(&interp_query<region_t, region_t, region_t>);
+        case 4: return reinterpret_cast<intptr_t>(&interp_query<region_t, region_t, region_t, region_t>);
+        case 5: return reinterpret_cast<intptr_t>(&interp_query<region_t, region_t, region_t, region_t, region_t>);
+        case 6:
+            return reinterpret_cast<intptr_t>(&interp_query<region_t, region_t, region_t, region_t, region_t, region_t>);
+        default: throw runtime_error("Interpreter: queries take up to 6 inputs");
+    }
+}
+
+#endif  // TILT_BENCH_INCLUDE_TILT_INTERP_H_
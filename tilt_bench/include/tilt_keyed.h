@@ -0,0 +1,340 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_KEYED_H_
+#define TILT_BENCH_INCLUDE_TILT_KEYED_H_
+
+#include <vector>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* keyed variants of algotrading (_MACrossOver) and rsi (_RSICalc) over an
+ * interleaved multi-symbol feed. TiLT has no keyed state, so these run as
+ * native kernels over TiLT regions, with per-symbol state kept in dense
+ * struct-of-arrays tables indexed by symbol. Windows count events of the
+ * same symbol, so a single-symbol feed gives the same result as the unkeyed
+ * queries at period 1. */
+
+struct Tick {
+    int32_t sym;
+    float price;
+};
+
+class TickData : public Dataset<Tick> {
+public:
+    TickData(dur_t period, int64_t len, int32_t symbols) :
+        period(period), len(len), symbols(symbols)
+    {}
+
+    void fill(region_t* reg) final
+    {
+        // every symbol follows its own random walk around a random base price
+        vector<float> last(symbols);
+        for (int32_t s = 0; s < symbols; s++) {
+            last[s] = static_cast<float>(rand() % 1000) + 10;
+        }
+
+        ArrivalGen arrivals(arrival_spec, period, len);
+
+        for (int i = 0; i < len; i++) {
+            auto iv = arrivals.next();
+            auto t = iv.t;
+            if (get_end_time(reg) < t - iv.d) {
+                commit_null(reg, t - iv.d);
+            }
+            commit_data(reg, t);
+            auto sym = rand() % symbols;
+            last[sym] += static_cast<float>(rand() % 101 - 50) / 100;
+            auto* ptr = reinterpret_cast<Tick*>(fetch(reg, t, get_end_idx(reg), sizeof(Tick)));
+            *ptr = Tick{sym, last[sym]};
+        }
+    }
+
+private:
+    dur_t period;
+    int64_t len;
+    int32_t symbols;
+};
+
+// Per-symbol state of the moving average cross over. The price history is one
+// ring of w_long entries per symbol, laid out back to back.
+struct MAStateTable {
+    MAStateTable(int32_t symbols, int64_t w_short, int64_t w_long) :
+        w_short(w_short), w_long(w_long),
+        short_sum(symbols, 0), long_sum(symbols, 0), count(symbols, 0),
+        hist(symbols * w_long, 0)
+    {}
+
+    int8_t update(int32_t s, float price)
+    {
+        auto n = count[s];
+        auto* ring = hist.data() + s * w_long;
+
+        short_sum[s] += price - ((n >= w_short) ? ring[(n - w_short) % w_long] : 0);
+        long_sum[s] += price - ((n >= w_long) ? ring[n % w_long] : 0);
+        ring[n % w_long] = price;
+        count[s] = n + 1;
+
+        auto short_avg = short_sum[s] / min(n + 1, w_short);
+        auto long_avg = long_sum[s] / min(n + 1, w_long);
+        return short_avg > long_avg;
+    }
+
+    int64_t bytes() const
+    {
+        return (short_sum.size() + long_sum.size() + hist.size()) * sizeof(float)
+            + count.size() * sizeof(int64_t);
+    }
+
+    int64_t w_short;
+    int64_t w_long;
+    vector<float> short_sum;
+    vector<float> long_sum;
+    vector<int64_t> count;
+    vector<float> hist;
+};
+
+// Per-symbol state of the relative strength index. The price differences are
+// kept in one ring of `window` entries per symbol.
+struct RSIStateTable {
+    RSIStateTable(int32_t symbols, int64_t window) :
+        window(window),
+        prev(symbols, 0), pos_sum(symbols, 0), neg_sum(symbols, 0), count(symbols, 0),
+        hist(symbols * window, 0)
+    {}
+
+    float update(int32_t s, float price)
+    {
+        auto n = count[s];
+        auto* ring = hist.data() + s * window;
+
+        // same sign convention as _DailyDiff
+        auto diff = (n > 0) ? prev[s] - price : 0;
+        auto tail = (n >= window) ? ring[n % window] : 0;
+
+        pos_sum[s] += ((diff > 0) ? diff : 0) - ((tail > 0) ? tail : 0);
+        neg_sum[s] += ((diff < 0) ? -diff : 0) - ((tail < 0) ? -tail : 0);
+        ring[n % window] = diff;
+        prev[s] = price;
+        count[s] = n + 1;
+
+        return 100 - (100 / (1 + (pos_sum[s] / neg_sum[s])));
+    }
+
+    int64_t bytes() const
+    {
+        return (prev.size() + pos_sum.size() + neg_sum.size() + hist.size()) * sizeof(float)
+            + count.size() * sizeof(int64_t);
+    }
+
+    int64_t window;
+    vector<float> prev;
+    vector<float> pos_sum;
+    vector<float> neg_sum;
+    vector<int64_t> count;
+    vector<float> hist;
+};
+
+template<typename State, typename Out>
+void keyed_scan(region_t* out_reg, region_t* in_reg, State& state)
+{
+    auto end = get_end_idx(in_reg);
+    for (idx_t i = get_start_idx(in_reg) + 1; i <= end; i++) {
+        auto iv = in_reg->tl[i & in_reg->mask];
+        if (iv.d == 0) {
+            continue;
+        }
+        auto t = iv.t + iv.d;
+        auto tick = reinterpret_cast<Tick*>(fetch(in_reg, t, i, sizeof(Tick)));
+        auto res = state.update(tick->sym, tick->price);
+
+        if (get_end_time(out_reg) < iv.t) {
+            commit_null(out_reg, iv.t);
+        }
+        commit_data(out_reg, t);
+        *reinterpret_cast<Out*>(fetch(out_reg, t, get_end_idx(out_reg), sizeof(Out))) = res;
+    }
+}
+
+// Reference of the keyed kernels: the prices of every symbol run through
+// f(prices) on their own, and the results are merged back in input order
+template<typename Out, typename F>
+vector<RefEvent<Out>> ref_keyed(region_t* in, int32_t symbols, F f)
+{
+    auto ticks = ref_input<Tick>(in);
+    vector<vector<float>> prices(symbols);
+    for (auto& e : ticks) {
+        prices[e.v.sym].push_back(e.v.price);
+    }
+    vector<vector<Out>> res(symbols);
+    for (int32_t s = 0; s < symbols; s++) {
+        res[s] = f(prices[s]);
+    }
+    vector<RefEvent<Out>> out;
+    vector<size_t> next(symbols, 0);
+    for (auto& e : ticks) {
+        out.push_back(RefEvent<Out>{e.t, res[e.v.sym][next[e.v.sym]++]});
+    }
+    return out;
+}
+
+// Moving average cross over of one symbol, windows counting its events
+inline vector<int8_t> ref_symbol_moca(const vector<float>& vals, int64_t w_short, int64_t w_long)
+{
+    vector<int8_t> out;
+    float ssum = 0, lsum = 0;
+    for (int64_t i = 0; i < static_cast<int64_t>(vals.size()); i++) {
+        ssum += vals[i] - ref_at(vals, i, w_short);
+        lsum += vals[i] - ref_at(vals, i, w_long);
+        auto savg = ssum / min(i + 1, w_short);
+        auto lavg = lsum / min(i + 1, w_long);
+        out.push_back(savg > lavg);
+    }
+    return out;
+}
+
+// Relative strength index of one symbol over its last `window` differences
+inline vector<float> ref_symbol_rsi(const vector<float>& vals, int64_t window)
+{
+    int64_t n = vals.size();
+    vector<float> diff(n), out;
+    float pos = 0, neg = 0;
+    for (int64_t i = 0; i < n; i++) {
+        diff[i] = (i > 0) ? vals[i - 1] - vals[i] : 0;
+        auto head = diff[i];
+        auto tail = ref_at(diff, i, window);
+        pos += ((head > 0) ? head : 0) - ((tail > 0) ? tail : 0);
+        neg += ((head < 0) ? -head : 0) - ((tail < 0) ? -tail : 0);
+        out.push_back(100 - (100 / (1 + (pos / neg))));
+    }
+    return out;
+}
+
+class KeyedBench : public Benchmark {
+public:
+    KeyedBench(dur_t period, int32_t symbols, int64_t size) :
+        period(period), symbols(symbols), size(size)
+    {}
+
+    bool native() override { return true; }
+
+    // no TiLT query to compile, execute() runs the native kernel
+    intptr_t compile() override { return 0; }
+
+protected:
+    Op query() final
+    {
+        throw runtime_error("Keyed benchmarks have no TiLT query");
+    }
+
+    dur_t period;
+    int32_t symbols;
+    int64_t size;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+class KeyedMOCABench : public KeyedBench {
+public:
+    KeyedMOCABench(dur_t period, int32_t symbols, int64_t w_short, int64_t w_long, int64_t size) :
+        KeyedBench(period, symbols, size), w_short(w_short), w_long(w_long)
+    {}
+
+private:
+    void init() final
+    {
+        in_reg = create_in_reg<Tick>(size);
+        out_reg = create_in_reg<int8_t>(size);
+        state = new MAStateTable(symbols, w_short, w_long);
+
+        TickData dataset(period, size, symbols);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t) final
+    {
+        keyed_scan<MAStateTable, int8_t>(&out_reg, &in_reg, *state);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_keyed<int8_t>(&in_reg, symbols, [this](const vector<float>& vals) {
+            return ref_symbol_moca(vals, w_short, w_long);
+        }));
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+        delete state;
+    }
+
+    int64_t w_short;
+    int64_t w_long;
+    MAStateTable* state;
+};
+
+class ParallelKeyedMOCABench : public ParallelBenchmark {
+public:
+    ParallelKeyedMOCABench(int threads, dur_t period, int32_t symbols, int64_t w_short, int64_t w_long, int64_t size)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new KeyedMOCABench(period, symbols, w_short, w_long, size));
+        }
+    }
+};
+
+class KeyedRSIBench : public KeyedBench {
+public:
+    KeyedRSIBench(dur_t period, int32_t symbols, int64_t window, int64_t size) :
+        KeyedBench(period, symbols, size), window(window)
+    {}
+
+private:
+    void init() final
+    {
+        in_reg = create_in_reg<Tick>(size);
+        out_reg = create_in_reg<float>(size);
+        state = new RSIStateTable(symbols, window);
+
+        TickData dataset(period, size, symbols);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t) final
+    {
+        keyed_scan<RSIStateTable, float>(&out_reg, &in_reg, *state);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_keyed<float>(&in_reg, symbols, [this](const vector<float>& vals) {
+            return ref_symbol_rsi(vals, window);
+        }));
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+        delete state;
+    }
+
+    int64_t window;
+    RSIStateTable* state;
+};
+
+class ParallelKeyedRSIBench : public ParallelBenchmark {
+public:
+    ParallelKeyedRSIBench(int threads, dur_t period, int32_t symbols, int64_t window, int64_t size)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new KeyedRSIBench(period, symbols, window, size));
+        }
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_KEYED_H_
@@ -90,7 +90,7 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         out_reg = create_reg<KurtState>(size);
 
         SynthData<float> dataset(period, size);
@@ -103,6 +103,11 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_kurt<KurtState>(&in_reg, window));
+    }
+
     void release() final
     {
         release_reg(&in_reg);
@@ -0,0 +1,89 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_LATENCY_H_
+#define TILT_BENCH_INCLUDE_TILT_LATENCY_H_
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+// Input events per query invocation in micro-batch mode, set once from the
+// main.cpp flag --batch=<events>. 0 runs the query over the whole input.
+inline int64_t micro_batch = 0;
+
+// Log-linear histogram of non-negative values in the style of HdrHistogram.
+// Values below 2^kSubBits are counted exactly, larger ones by their kSubBits + 1
+// most significant bits, so every bucket is within 2^-kSubBits (< 1%) of the
+// values it holds. Recording is a shift and an increment.
+class LatencyHistogram {
+public:
+    static const int kSubBits = 7;
+
+    void record(int64_t v)
+    {
+        v = max<int64_t>(v, 0);
+        counts[index(v)]++;
+        total++;
+        sum += v;
+        max_val = max(max_val, v);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < counts.size(); i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        max_val = max(max_val, other.max_val);
+    }
+
+    // Smallest recorded value v such that a fraction `q` of the values are <= v,
+    // reported as the upper edge of its bucket
+    int64_t percentile(double q) const
+    {
+        if (total == 0) {
+            return 0;
+        }
+        auto target = max<int64_t>(static_cast<int64_t>(ceil(q * total)), 1);
+        int64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                return min(upper(i), max_val);
+            }
+        }
+        return max_val;
+    }
+
+    double mean() const { return total ? sum / total : 0; }
+
+    int64_t total = 0;
+    int64_t max_val = 0;
+
+private:
+    static size_t index(int64_t v)
+    {
+        if (v < (1 << kSubBits)) {
+            return v;
+        }
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - kSubBits;
+        return ((shift + 1) << kSubBits) + ((v >> shift) - (1 << kSubBits));
+    }
+
+    static int64_t upper(size_t idx)
+    {
+        if (idx < (1 << kSubBits)) {
+            return idx;
+        }
+        int shift = (idx >> kSubBits) - 1;
+        int64_t off = idx & ((1 << kSubBits) - 1);
+        return (((1ll << kSubBits) + off + 1) << shift) - 1;
+    }
+
+    vector<int64_t> counts = vector<int64_t>((64 - kSubBits + 1) << kSubBits, 0);
+    double sum = 0;
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_LATENCY_H_
@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_arena.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -125,9 +126,9 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
-        state_reg = create_reg<MOCAState>(scale);
-        out_reg = create_reg<bool>(size);
+        in_reg = create_in_reg<float>(size);
+        state_reg = RegionArena::Get(part)->state<MOCAState>(scale, query(), 1);
+        out_reg = create_out_reg<bool>(size, size);
 
         SynthData<float> dataset(period, size);
         dataset.fill(&in_reg);
@@ -135,14 +136,18 @@ private:
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg, &state_reg);
+        run_query(addr, period * size, size, period * scale, &out_reg, &in_reg, state_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_moca(&in_reg, period, w_short, w_long));
     }
 
     void release() final
     {
         release_reg(&in_reg);
-        release_reg(&state_reg);
+        RegionArena::Get(part)->reset();
         release_reg(&out_reg);
     }
 
@@ -152,7 +157,7 @@ private:
     int64_t scale;
     int64_t size;
     region_t in_reg;
-    region_t state_reg;
+    region_t* state_reg;
     region_t out_reg;
 };
 
@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_fuse.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -62,6 +63,15 @@ public:
         period(period), window(window), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
+    // the fused kernel, which writes the same output
+    intptr_t tier0() override
+    {
+        norm_stream_window = window;
+        return reinterpret_cast<intptr_t>(&norm_stream);
+    }
+
 private:
     Op query() final
     {
@@ -71,8 +81,8 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
-        out_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
+        out_reg = create_out_reg<float>(size, size);
 
         SynthData<float> dataset(period, size);
         dataset.fill(&in_reg);
@@ -80,8 +90,12 @@ private:
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, window, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_norm(&in_reg, window));
     }
 
     void release() final
@@ -171,6 +185,8 @@ public:
         period(period), window(window), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -180,8 +196,8 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
-        out_reg = create_reg<float>(size);
+        in_reg = create_in_reg<int64_t>(size);
+        out_reg = create_out_reg<float>(size, size);
 
         SynthData<int64_t> dataset(period, size);
         dataset.fill(&in_reg);
@@ -189,8 +205,12 @@ private:
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, window, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_norm64(&in_reg, window));
     }
 
     void release() final
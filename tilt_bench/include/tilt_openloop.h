@@ -0,0 +1,190 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_OPENLOOP_H_
+#define TILT_BENCH_INCLUDE_TILT_OPENLOOP_H_
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+#include "tilt_latency.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Open-loop driver.
+ *
+ * The other benchmarks are closed-loop: the whole input is in memory before
+ * the clock starts. Here a producer thread emits the events of a single float
+ * stream at a fixed rate into a bounded SPSC ring, and the calling thread
+ * pulls them into a sliding input region and runs the query over everything
+ * that arrived since its last invocation. Event k is due at start + k / rate.
+ * Its latency is taken from that intended send time to the end of the query
+ * invocation that covered it, so a producer held back by a full ring or a
+ * late scheduler does not hide the queueing delay (coordinated omission). */
+
+struct RingEvent {
+    ival_t iv;
+    float v;
+};
+
+class OpenLoopBench : public Benchmark {
+public:
+    // `align` is the granularity of the query's output (its window for
+    // tumbling windows) and `lookback` how far back in time it reads its input
+    OpenLoopBench(function<Op(_sym)> build, dur_t period, dur_t align, dur_t lookback, int64_t size, double rate) :
+        build(build), period(period), align(align), lookback(lookback), size(size), rate(rate)
+    {}
+
+private:
+    static const int64_t kRingEvents = 1 << 16;
+
+    Op query() final
+    {
+        auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        return build(in_sym);
+    }
+
+    void init() final
+    {
+        src_reg = create_in_reg<float>(size);
+        SynthData<float> dataset(period, size);
+        dataset.fill(&src_reg);
+
+        ring.resize(kRingEvents);
+        in_reg = create_in_reg<float>(2 * kRingEvents + (lookback + align) / period + 1);
+        if (sink_spec.mode == SinkMode::FULL) {
+            out_reg = create_out_reg<float>(size, size);
+        } else {
+            sink.open(sizeof(float), to_string(part));
+            out_reg = create_reg<float>(2 * kRingEvents + align / period + 1);
+        }
+        latency = LatencyHistogram();
+    }
+
+    // Emits the events of src_reg on schedule. Only the events that are due
+    // and fit into the ring are published, the rest wait for the consumer.
+    void produce(steady_clock::time_point start)
+    {
+        auto gap = 1e9 / rate;
+        idx_t i = get_start_idx(&src_reg);
+        int64_t k = 0;
+        while (k < size) {
+            auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+            auto due = min<int64_t>(size, static_cast<int64_t>(elapsed / gap) + 1);
+            auto n = min(due, consumed.load(memory_order_acquire) + kRingEvents) - k;
+            if (n <= 0) {
+                this_thread::yield();
+                continue;
+            }
+            for (; n > 0; n--, k++) {
+                do {
+                    i++;
+                } while (src_reg.tl[i & src_reg.mask].d == 0);
+                auto iv = src_reg.tl[i & src_reg.mask];
+                auto v = *reinterpret_cast<float*>(fetch(&src_reg, iv.t + iv.d, i, sizeof(float)));
+                ring[k % kRingEvents] = RingEvent{iv, v};
+            }
+            produced.store(k, memory_order_release);
+        }
+    }
+
+    void execute(intptr_t addr) final
+    {
+        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
+        auto gap = 1e9 / rate;
+        auto end = get_end_time(&src_reg);
+
+        produced.store(0);
+        consumed.store(0);
+        auto start = steady_clock::now();
+        thread producer([this, start]() { produce(start); });
+
+        int64_t k = 0;
+        int64_t done = 0;
+        idx_t done_idx = get_start_idx(&in_reg);
+        ts_t last = 0;
+        while (done < size) {
+            // move the arrived events into the input region and free their slots
+            auto p = produced.load(memory_order_acquire);
+            for (; k < p; k++) {
+                auto& e = ring[k % kRingEvents];
+                if (get_end_time(&in_reg) < e.iv.t) {
+                    commit_null(&in_reg, e.iv.t);
+                }
+                auto t = e.iv.t + e.iv.d;
+                commit_data(&in_reg, t);
+                *reinterpret_cast<float*>(fetch(&in_reg, t, get_end_idx(&in_reg), sizeof(float))) = e.v;
+            }
+            consumed.store(k, memory_order_release);
+
+            ts_t t = (k == size) ? end : (get_end_time(&in_reg) / align) * align;
+            if (t <= last) {
+                this_thread::yield();
+                continue;
+            }
+
+            auto from = get_end_idx(&out_reg);
+            query(last, t, &out_reg, &in_reg);
+            auto now = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+            if (sink_spec.mode != SinkMode::FULL) {
+                sink.consume(&out_reg, from, get_end_idx(&out_reg));
+            }
+            last = t;
+
+            // every event ending by t is complete
+            while (done_idx < get_end_idx(&in_reg)) {
+                auto iv = in_reg.tl[(done_idx + 1) & in_reg.mask];
+                if (iv.t + iv.d > t) {
+                    break;
+                }
+                done_idx++;
+                if (iv.d > 0) {
+                    latency.record(now - static_cast<int64_t>(done * gap));
+                    done++;
+                }
+            }
+
+            // entries older than the lookback are not read again
+            trim_reg(&in_reg, t - lookback);
+        }
+
+        producer.join();
+        sink.close();
+    }
+
+    void release() final
+    {
+        release_reg(&src_reg);
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    function<Op(_sym)> build;
+    dur_t period;
+    dur_t align;
+    dur_t lookback;
+    int64_t size;
+    double rate;
+
+    region_t src_reg;
+    region_t in_reg;
+    region_t out_reg;
+    vector<RingEvent> ring;
+    atomic<int64_t> produced;
+    atomic<int64_t> consumed;
+};
+
+class ParallelOpenLoopBench : public ParallelBenchmark {
+public:
+    ParallelOpenLoopBench(int threads, function<Op(_sym)> build, dur_t period, dur_t align, dur_t lookback,
+        int64_t size, double rate)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new OpenLoopBench(build, period, align, lookback, size, rate));
+        }
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_OPENLOOP_H_
@@ -26,8 +26,8 @@ private:
 
     void init() final
     {
-        left_reg = create_reg<float>(size);
-        right_reg = create_reg<float>(size);
+        left_reg = create_in_reg<float>(size);
+        right_reg = create_in_reg<float>(size);
         float ratio = (float) max(lperiod, rperiod) / (float) min(lperiod, rperiod);
         int osize = size * ceil(ratio);
         out_reg = create_reg<float>(osize);
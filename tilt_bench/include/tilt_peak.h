@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_arena.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -226,11 +227,13 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
-        low_state_reg = create_reg<float>(scale);
-        high_state_reg = create_reg<float>(scale);
-        ma_state_reg = create_reg<AvgState>(scale);
-        out_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
+        auto query_op = query();
+        auto arena = RegionArena::Get(part);
+        low_state_reg = arena->state<float>(scale, query_op, 1);
+        high_state_reg = arena->state<float>(scale, query_op, 2);
+        ma_state_reg = arena->state<AvgState>(scale, query_op, 3);
+        out_reg = create_out_reg<float>(size, size);
 
         SynthData<float> dataset(period, size);
         dataset.fill(&in_reg);
@@ -238,16 +241,19 @@ private:
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg, &low_state_reg, &high_state_reg, &ma_state_reg);
+        run_query(addr, period * size, size, period * scale,
+            &out_reg, &in_reg, low_state_reg, high_state_reg, ma_state_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_pantom(&in_reg, period, window));
     }
 
     void release() final
     {
         release_reg(&in_reg);
-        release_reg(&low_state_reg);
-        release_reg(&high_state_reg);
-        release_reg(&ma_state_reg);
+        RegionArena::Get(part)->reset();
         release_reg(&out_reg);
     }
 
@@ -256,9 +262,9 @@ private:
     int64_t scale;
     int64_t size;
     region_t in_reg;
-    region_t low_state_reg;
-    region_t high_state_reg;
-    region_t ma_state_reg;
+    region_t* low_state_reg;
+    region_t* high_state_reg;
+    region_t* ma_state_reg;
     region_t out_reg;
 };
 
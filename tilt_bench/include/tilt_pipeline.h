@@ -0,0 +1,622 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_PIPELINE_H_
+#define TILT_BENCH_INCLUDE_TILT_PIPELINE_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_base.h"
+#include "tilt_bench.h"
+#include "tilt_arena.h"
+#include "tilt_select.h"
+#include "tilt_peak.h"
+#include "tilt_norm.h"
+#include "tilt_eg.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Pipeline-parallel execution of composite queries.
+ *
+ * A query is cut at some of its _sym boundaries into stages. Every stage is
+ * compiled as a query of its own and runs on its own thread over the same
+ * time slices, reading the regions written by earlier stages through SPSC
+ * region queues. The fused query runs through the same driver as a single
+ * stage, so the two are compared under the same slicing. */
+
+// Single producer single consumer queue of region entries. The producer
+// appends to `reg` and publishes its end index and the time up to which it
+// is complete. The consumer reads through its own copy of the region header
+// and publishes the oldest index it still reads, which bounds the producer.
+struct RegionQueue {
+    region_t reg = {};
+    atomic<idx_t> head;
+    atomic<ts_t> time;
+    atomic<idx_t> tail;
+};
+
+const int kPipelineSource = -1;
+
+struct PipelineStage {
+    // Params of the query: its inputs, then its state regions
+    Op op;
+    // kPipelineSource or the index of an earlier stage, per input
+    vector<int> inputs;
+    // output payload bytes
+    int64_t width;
+    // payload bytes of the state regions, which hold the `state_len` events
+    // the query writes per call and as many past ones as it reads back
+    vector<int64_t> states;
+    int64_t state_len;
+    // how far before the start of a slice the stage reads its inputs
+    dur_t lookback;
+    // operator of the stage in profiles
+    string name;
+};
+
+// Wraps the operators added by `inner` into a stage iterating like the fused
+// query: every iteration of `iter` ticks reads its inputs over
+// (t - iter - lookback, t]. `inner` adds its syms and the Aux entries of its
+// recursive states, and returns the result sym.
+Op _PipeStage(vector<_sym> ins, vector<_sym> states, int64_t iter, int64_t lookback,
+    function<_sym(vector<_sym>, SymTable&, Aux&)> inner)
+{
+    SymTable syms;
+    Aux aux;
+    vector<_sym> wins;
+    for (size_t i = 0; i < ins.size(); i++) {
+        auto win = ins[i][_win(-iter - lookback, 0)];
+        auto win_sym = _sym("win" + to_string(i), win);
+        syms[win_sym] = win;
+        wins.push_back(win_sym);
+    }
+    auto res_sym = inner(wins, syms, aux);
+
+    Params params(ins.begin(), ins.end());
+    params.insert(params.end(), states.begin(), states.end());
+
+    return _op(
+        _iter(0, iter),
+        params,
+        syms,
+        _true(),
+        res_sym,
+        aux);
+}
+
+// Calls a compiled query with the output region followed by its Params
+region_t* call_query(intptr_t addr, ts_t t_start, ts_t t_end, vector<region_t*>& regs)
+{
+    switch (regs.size()) {
+        case 2:
+            return ((region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr)(
+                t_start, t_end, regs[0], regs[1]);
+        case 3:
+            return ((region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr)(
+                t_start, t_end, regs[0], regs[1], regs[2]);
+        case 4:
+            return ((region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*, region_t*)) addr)(
+                t_start, t_end, regs[0], regs[1], regs[2], regs[3]);
+        case 5:
+            return ((region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*, region_t*, region_t*)) addr)(
+                t_start, t_end, regs[0], regs[1], regs[2], regs[3], regs[4]);
+        default:
+            throw runtime_error("Unsupported number of stage regions");
+    }
+}
+
+// A region of `size` entries of `width` byte payloads
+region_t create_width_reg(int64_t width, int64_t size)
+{
+    region_t reg;
+    auto buf_size = get_buf_size(size);
+    auto tl = new ival_t[buf_size];
+    auto data = new char[buf_size * width];
+    init_region(&reg, 0, buf_size, tl, data);
+    return reg;
+}
+
+// Compiled stages of every pipeline of the process. The address of an entry
+// stands for the compiled pipeline, so runs reusing it by code key find all
+// of its stages; entries live as long as the code they point to.
+inline list<vector<intptr_t>> pipeline_addrs;
+
+template<typename OutTy>
+class PipelineBench : public Benchmark {
+public:
+    PipelineBench(dur_t period, dur_t align, int64_t size) :
+        period(period), align(align), size(size)
+    {}
+
+    intptr_t compile() final
+    {
+        auto specs = stages();
+        vector<intptr_t> stage_addrs;
+        for (size_t i = 0; i < specs.size(); i++) {
+            stage_addrs.push_back(compile_op(specs[i].op, "stage" + to_string(i)));
+        }
+        pipeline_addrs.push_back(stage_addrs);
+        return reinterpret_cast<intptr_t>(&pipeline_addrs.back());
+    }
+
+    // the plan is a list of stages rather than one query, so it has no tier 0
+    intptr_t tier0() final { return 0; }
+
+protected:
+    virtual vector<PipelineStage> stages() = 0;
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Pipelined benchmarks compile their stages separately");
+    }
+
+    void init() final
+    {
+        specs = stages();
+        op_counters.assign(specs.size(), OpCounters());
+        for (size_t s = 0; s < specs.size(); s++) {
+            op_counters[s].name = specs[s].name;
+        }
+        in_reg = create_in_reg<float>(size);
+        SynthData<float> dataset(period, size);
+        dataset.fill(&in_reg);
+
+        auto end = period * size;
+        step = max<ts_t>(end * slice_events() / size, 1);
+        step = ((step + align - 1) / align) * align;
+        batch_events = (step * size + end - 1) / end;
+        latency = LatencyHistogram();
+
+        // every queue holds a few slices plus the lookback of its consumer
+        queues = vector<RegionQueue>(specs.size());
+        views.assign(specs.size(), vector<region_t>());
+        for (size_t s = 0; s < specs.size(); s++) {
+            for (auto in : specs[s].inputs) {
+                if (in != kPipelineSource) {
+                    auto len = 4 * (step + specs[s].lookback) / period + 16;
+                    queues[in].reg = create_width_reg(specs[in].width, len);
+                }
+            }
+            states.push_back(vector<region_t*>());
+            auto arena = RegionArena::Get(part);
+            for (size_t j = 0; j < specs[s].states.size(); j++) {
+                auto input = specs[s].inputs.size() + j;
+                states[s].push_back(arena->state(specs[s].states[j], specs[s].state_len, specs[s].op, input));
+            }
+        }
+        if (sink_spec.mode == SinkMode::FULL) {
+            out_reg = create_out_reg<OutTy>(size, size);
+        } else {
+            // a slice is rounded up to whole iterations, so the ring is sized
+            // by the slice actually run
+            sink.open(sizeof(OutTy), to_string(part));
+            out_reg = create_reg<OutTy>(4 * batch_events + 16);
+        }
+
+        // consumers read through their own copy of the region headers, taken
+        // before any stage runs
+        for (size_t s = 0; s < specs.size(); s++) {
+            for (auto in : specs[s].inputs) {
+                views[s].push_back((in == kPipelineSource) ? in_reg : queues[in].reg);
+            }
+        }
+    }
+
+    void run_stage(size_t s, ts_t end, vector<steady_clock::time_point>& starts)
+    {
+        auto& spec = specs[s];
+        bool last = (s + 1 == specs.size());
+        auto out = last ? &out_reg : &queues[s].reg;
+        auto half = (out->mask + 1) / 2;
+
+        auto& in_views = views[s];
+        vector<region_t*> regs{out};
+        for (auto& view : in_views) {
+            regs.push_back(&view);
+        }
+        for (auto state : states[s]) {
+            regs.push_back(state);
+        }
+
+#ifdef _PROFILE_OPS_
+        auto& prof = op_counters[s];
+        vector<idx_t> seen;
+        for (auto& view : in_views) {
+            seen.push_back(get_start_idx(&view));
+        }
+#endif // _PROFILE_OPS_
+
+        int64_t k = 0;
+        for (ts_t t = 0; t < end; t += step, k++) {
+            auto t_end = min(t + step, end);
+            for (size_t i = 0; i < spec.inputs.size(); i++) {
+                auto in = spec.inputs[i];
+                if (in == kPipelineSource) {
+                    continue;
+                }
+                while (queues[in].time.load(memory_order_acquire) < t_end) {
+                    if (overflow.load(memory_order_relaxed)) {
+                        return;
+                    }
+                    this_thread::yield();
+                }
+                in_views[i].ei = queues[in].head.load(memory_order_acquire);
+            }
+            if (!last) {
+                while (get_end_idx(out) - queues[s].tail.load(memory_order_acquire) > half) {
+                    if (overflow.load(memory_order_relaxed)) {
+                        return;
+                    }
+                    this_thread::yield();
+                }
+            }
+            if (s == 0) {
+                starts[k] = steady_clock::now();
+            }
+
+            auto from = get_end_idx(out);
+#ifdef _PROFILE_OPS_
+            for (size_t i = 0; i < in_views.size(); i++) {
+                auto& view = in_views[i];
+                auto to = seen[i];
+                while (to < get_end_idx(&view)) {
+                    auto iv = view.tl[(to + 1) & view.mask];
+                    if (iv.t + iv.d > t_end) {
+                        break;
+                    }
+                    to++;
+                }
+                prof.events_in += count_events(&view, seen[i], to);
+                seen[i] = to;
+            }
+            auto tsc = __rdtsc();
+            call_query(addrs->at(s), t, t_end, regs);
+            prof.cycles += __rdtsc() - tsc;
+            prof.calls++;
+            prof.events_out += count_events(out, from, get_end_idx(out));
+#else
+            call_query(addrs->at(s), t, t_end, regs);
+#endif // _PROFILE_OPS_
+
+            // a slice over half the ring may have lapped its consumer, which
+            // stops every stage
+            if (get_end_idx(out) - from > half) {
+                overflow.store(true, memory_order_relaxed);
+                return;
+            }
+
+            if (last) {
+                auto now = steady_clock::now();
+                latency.record(duration_cast<nanoseconds>(now - starts[k]).count());
+                if (sink_spec.mode != SinkMode::FULL) {
+                    sink.consume(out, from, get_end_idx(out));
+                }
+            } else {
+                queues[s].head.store(get_end_idx(out), memory_order_release);
+                queues[s].time.store(t_end, memory_order_release);
+            }
+
+            // release the input entries the next slice does not read
+            for (size_t i = 0; i < spec.inputs.size(); i++) {
+                auto in = spec.inputs[i];
+                if (in != kPipelineSource) {
+                    trim_reg(&in_views[i], t_end - spec.lookback);
+                    queues[in].tail.store(get_start_idx(&in_views[i]), memory_order_release);
+                }
+            }
+        }
+    }
+
+    void execute(intptr_t addr) final
+    {
+        addrs = reinterpret_cast<const vector<intptr_t>*>(addr);
+        auto end = period * size;
+        vector<steady_clock::time_point> starts((end + step - 1) / step);
+        for (auto& q : queues) {
+            q.head.store(0);
+            q.time.store(-1);
+            q.tail.store(0);
+        }
+        overflow.store(false);
+
+        vector<thread> workers;
+        for (size_t s = 0; s + 1 < specs.size(); s++) {
+            workers.push_back(thread([this, s, end, &starts]() { run_stage(s, end, starts); }));
+        }
+        run_stage(specs.size() - 1, end, starts);
+        for (auto& w : workers) {
+            w.join();
+        }
+        sink.close();
+
+        if (overflow) {
+            throw runtime_error("Pipeline ring overflow");
+        }
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+        for (size_t s = 0; s < specs.size(); s++) {
+            if (queues[s].reg.tl != nullptr) {
+                release_reg(&queues[s].reg);
+            }
+        }
+        states.clear();
+        RegionArena::Get(part)->reset();
+    }
+
+protected:
+    dur_t period;
+    dur_t align;
+    int64_t size;
+    region_t in_reg;
+    region_t out_reg;
+
+private:
+    const vector<intptr_t>* addrs = nullptr;
+    vector<PipelineStage> specs;
+    ts_t step;
+    vector<RegionQueue> queues;
+    vector<vector<region_t>> views;
+    vector<vector<region_t*>> states;
+    atomic<bool> overflow;
+};
+
+// _PanTom as one stage, or cut after the low pass, high pass and derivative.
+// Every stage reads its input as far back as its operator: 12, 32 and 4
+// periods, and the window of the moving average.
+class PanTomPipelineBench : public PipelineBench<float> {
+public:
+    PanTomPipelineBench(int64_t period, int64_t window, int64_t scale, int64_t size, bool fused) :
+        PipelineBench(period, period * scale, size), window(window), scale(scale), fused(fused)
+    {}
+
+private:
+    vector<PipelineStage> stages() final
+    {
+        auto p = period;
+        auto w = window;
+        auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        if (fused) {
+            return {
+                {_PanTom(in_sym, p, w, scale), {kPipelineSource}, sizeof(float),
+                    {sizeof(float), sizeof(float), sizeof(AvgState)}, scale, w, "pantom"}
+            };
+        }
+
+        auto low_state = _sym("low_state", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto lp = _PipeStage({in_sym}, {low_state}, p * scale, 12 * p, [p, low_state](vector<_sym> wins, SymTable& syms, Aux& aux) {
+            auto lp = _LowPass(wins[0], p);
+            auto lp_sym = _sym("lp", lp);
+            syms[lp_sym] = lp;
+            aux[lp_sym] = low_state;
+            return lp_sym;
+        });
+
+        auto lp_sym = _sym("lp", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto high_state = _sym("high_state", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto hp = _PipeStage({lp_sym}, {high_state}, p * scale, 32 * p, [p, high_state](vector<_sym> wins, SymTable& syms, Aux& aux) {
+            auto hp = _HighPass(wins[0], p);
+            auto hp_sym = _sym("hp", hp);
+            syms[hp_sym] = hp;
+            aux[hp_sym] = high_state;
+            return hp_sym;
+        });
+
+        auto hp_sym = _sym("hp", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto derv = _PipeStage({hp_sym}, {}, p * scale, 4 * p, [p](vector<_sym> wins, SymTable& syms, Aux&) {
+            auto derv = _Derive(wins[0], p);
+            auto derv_sym = _sym("derv", derv);
+            syms[derv_sym] = derv;
+            return derv_sym;
+        });
+
+        auto derv_sym = _sym("derv", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto ma_state = _sym("ma_state", tilt::Type(types::STRUCT<float, float>(), _iter(0, -1)));
+        auto ma = _PipeStage({derv_sym}, {ma_state}, p * scale, w, [p, w, ma_state](vector<_sym> wins, SymTable& syms, Aux& aux) {
+            auto ma = _MovingSqAvg(wins[0], p, w);
+            auto ma_sym = _sym("ma", ma);
+            auto val = _f32(0);
+            auto val_sym = _sym("val", val);
+            auto sel = _Select(ma_sym, val_sym, [](_sym e, _sym val) {
+                auto sum = e << 0;
+                auto count = e << 1;
+                return sum / count;
+            });
+            auto sel_sym = _sym("sel", sel);
+            syms[ma_sym] = ma;
+            syms[val_sym] = val;
+            syms[sel_sym] = sel;
+            aux[ma_sym] = ma_state;
+            return sel_sym;
+        });
+
+        return {
+            {lp, {kPipelineSource}, sizeof(float), {sizeof(float)}, scale, 12 * p, "lowpass"},
+            {hp, {0}, sizeof(float), {sizeof(float)}, scale, 32 * p, "highpass"},
+            {derv, {1}, sizeof(float), {}, 0, 4 * p, "derive"},
+            {ma, {2}, sizeof(float), {sizeof(AvgState)}, scale, w, "movingsqavg"},
+        };
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_pantom(&in_reg, period, window));
+    }
+
+    int64_t window;
+    int64_t scale;
+    bool fused;
+};
+
+class ParallelPanTomPipelineBench : public ParallelBenchmark {
+public:
+    ParallelPanTomPipelineBench(int threads, int64_t period, int64_t window, int64_t scale, int64_t size, bool fused)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new PanTomPipelineBench(period, window, scale, size, fused));
+        }
+    }
+};
+
+// _Norm as one stage, or cut after the centered values of every window
+class NormPipelineBench : public PipelineBench<float> {
+public:
+    NormPipelineBench(dur_t period, int64_t window, int64_t size, bool fused) :
+        PipelineBench(period, window, size), window(window), fused(fused)
+    {}
+
+private:
+    vector<PipelineStage> stages() final
+    {
+        auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        if (fused) {
+            return {{_Norm(in_sym, window), {kPipelineSource}, sizeof(float), {}, 0, 0, "normalize"}};
+        }
+
+        auto center = _PipeStage({in_sym}, {}, window, 0, [](vector<_sym> wins, SymTable& syms, Aux&) {
+            auto avg_state = _Average(wins[0], [](Expr e) { return e; });
+            auto avg_state_sym = _sym("avg_state", avg_state);
+            auto avg = _div(_get(avg_state_sym, 0), _get(avg_state_sym, 1));
+            auto avg_sym = _sym("avg", avg);
+            auto avg_op = _Select(wins[0], avg_sym, [](_sym e, _sym avg) { return e - avg; });
+            auto avg_op_sym = _sym("avgop", avg_op);
+            syms[avg_state_sym] = avg_state;
+            syms[avg_sym] = avg;
+            syms[avg_op_sym] = avg_op;
+            return avg_op_sym;
+        });
+
+        auto avg_op_sym = _sym("avgop", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto scale = _PipeStage({avg_op_sym}, {}, window, 0, [](vector<_sym> wins, SymTable& syms, Aux&) {
+            auto std_state = _Average(wins[0], [](Expr e) { return _mul(e, e); });
+            auto std_state_sym = _sym("stddev_state", std_state);
+            auto std = _sqrt(_div(_get(std_state_sym, 0), _get(std_state_sym, 1)));
+            auto std_sym = _sym("std", std);
+            auto std_op = _Select(wins[0], std_sym, [](_sym e, _sym std) { return e / std; });
+            auto std_op_sym = _sym("stdop", std_op);
+            syms[std_state_sym] = std_state;
+            syms[std_sym] = std;
+            syms[std_op_sym] = std_op;
+            return std_op_sym;
+        });
+
+        return {
+            {center, {kPipelineSource}, sizeof(float), {}, 0, 0, "center"},
+            {scale, {0}, sizeof(float), {}, 0, 0, "scale"},
+        };
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_norm(&in_reg, window));
+    }
+
+    int64_t window;
+    bool fused;
+};
+
+class ParallelNormPipelineBench : public ParallelBenchmark {
+public:
+    ParallelNormPipelineBench(int threads, dur_t period, int64_t window, int64_t size, bool fused)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new NormPipelineBench(period, window, size, fused));
+        }
+    }
+};
+
+// _Query1 as one stage, or as the two window averages feeding the join
+class Query1PipelineBench : public PipelineBench<int8_t> {
+public:
+    Query1PipelineBench(dur_t period, int64_t window, int64_t win1, int64_t win2, int64_t size, bool fused) :
+        PipelineBench(period, window, size), window(window), win1(win1), win2(win2), fused(fused)
+    {}
+
+private:
+    vector<PipelineStage> stages() final
+    {
+        auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        if (fused) {
+            return {{_Query1(in_sym, window, win1, win2), {kPipelineSource}, sizeof(int8_t), {}, 0, 0, "query1"}};
+        }
+
+        auto w1 = win1;
+        auto w2 = win2;
+        auto avg1 = _PipeStage({in_sym}, {}, window, 0, [w1](vector<_sym> wins, SymTable& syms, Aux&) {
+            auto wsum1 = _WindowSum(wins[0], w1);
+            auto wsum1_sym = _sym("wsum1", wsum1);
+            auto w = _f32(w1);
+            auto w_sym = _sym("w1", w);
+            auto avg1 = _Select(wsum1_sym, w_sym, [](_sym e, _sym w) { return e / w; });
+            auto avg1_sym = _sym("avg1", avg1);
+            syms[wsum1_sym] = wsum1;
+            syms[w_sym] = w;
+            syms[avg1_sym] = avg1;
+            return avg1_sym;
+        });
+        auto avg2 = _PipeStage({in_sym}, {}, window, 0, [w1, w2](vector<_sym> wins, SymTable& syms, Aux&) {
+            auto wsum2 = _WindowSum(wins[0], w2, w1);
+            auto wsum2_sym = _sym("wsum2", wsum2);
+            auto w = _f32(w2);
+            auto w_sym = _sym("w2", w);
+            auto avg2 = _Select(wsum2_sym, w_sym, [](_sym e, _sym w) { return e / w; });
+            auto avg2_sym = _sym("avg2", avg2);
+            syms[wsum2_sym] = wsum2;
+            syms[w_sym] = w;
+            syms[avg2_sym] = avg2;
+            return avg2_sym;
+        });
+
+        auto avg1_sym = _sym("avg1", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto avg2_sym = _sym("avg2", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        auto cmp = _PipeStage({avg1_sym, avg2_sym}, {}, window, 0, [](vector<_sym> wins, SymTable& syms, Aux&) {
+            auto join = _Join(wins[0], wins[1], [](_sym l, _sym r) { return _new(vector<Expr>{l, r}); });
+            auto join_sym = _sym("join", join);
+            auto zero = _f32(0);
+            auto zero_sym = _sym("zero", zero);
+            auto sel = _Select(join_sym, zero_sym, [](_sym e, _sym z) {
+                auto avg1 = e << 0;
+                auto avg2 = e << 1;
+                return _cast(types::INT8, _gt(avg1, avg2));
+            });
+            auto sel_sym = _sym("sel", sel);
+            syms[join_sym] = join;
+            syms[zero_sym] = zero;
+            syms[sel_sym] = sel;
+            return sel_sym;
+        });
+
+        return {
+            {avg1, {kPipelineSource}, sizeof(float), {}, 0, 0, "avg1"},
+            {avg2, {kPipelineSource}, sizeof(float), {}, 0, 0, "avg2"},
+            {cmp, {0, 1}, sizeof(int8_t), {}, 0, 0, "compare"},
+        };
+    }
+
+    int64_t window;
+    int64_t win1;
+    int64_t win2;
+    bool fused;
+};
+
+class ParallelQuery1PipelineBench : public ParallelBenchmark {
+public:
+    ParallelQuery1PipelineBench(int threads, dur_t period, int64_t window, int64_t win1, int64_t win2,
+        int64_t size, bool fused)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new Query1PipelineBench(period, window, win1, win2, size, fused));
+        }
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_PIPELINE_H_
@@ -0,0 +1,146 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_POOL_H_
+#define TILT_BENCH_INCLUDE_TILT_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Threads running a single query invocation, set once from the main.cpp flag
+// --intra=<threads>. 1 runs every query on the thread that calls it.
+inline int intra_threads = 1;
+
+// Work-stealing pool shared by all benchmarks of the process, with
+// intra_threads - 1 workers; the thread waiting for a batch runs its tasks too.
+// The tasks of a batch are dealt out to the workers in contiguous ranges, each
+// worker runs its own from the back and steals from the front of the others
+// when it runs dry, so uneven tasks even out without a central queue.
+class TaskPool {
+public:
+    static TaskPool* Get()
+    {
+        static TaskPool pool(intra_threads - 1);
+        return &pool;
+    }
+
+    ~TaskPool()
+    {
+        {
+            lock_guard<mutex> lk(m);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    // threads running tasks, the caller included
+    int size() const { return queues.size(); }
+
+    // Runs f(i) for every i in [0, n) and returns when all of them are done
+    void parallel_for(int64_t n, const function<void(int64_t)>& f)
+    {
+        atomic<int64_t> pending(n);
+        int64_t w = queues.size();
+        for (int64_t q = 0; q < w; q++) {
+            lock_guard<mutex> lk(queues[q].m);
+            for (auto i = n * q / w; i < n * (q + 1) / w; i++) {
+                queues[q].tasks.push_back(Task{&f, i, &pending});
+            }
+        }
+        {
+            lock_guard<mutex> lk(m);
+            queued.fetch_add(n);
+        }
+        cv.notify_all();
+
+        // the caller owns the last queue
+        while (pending.load(memory_order_acquire) > 0) {
+            if (!run_one(w - 1)) {
+                this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct Task {
+        const function<void(int64_t)>* f;
+        int64_t i;
+        atomic<int64_t>* pending;
+    };
+
+    struct Queue {
+        mutex m;
+        deque<Task> tasks;
+    };
+
+    explicit TaskPool(int workers_count) : queues(workers_count + 1)
+    {
+        for (int q = 0; q < workers_count; q++) {
+            workers.push_back(thread([this, q]() { work(q); }));
+        }
+    }
+
+    bool pop(size_t q, Task& task, bool steal)
+    {
+        lock_guard<mutex> lk(queues[q].m);
+        auto& tasks = queues[q].tasks;
+        if (tasks.empty()) {
+            return false;
+        }
+        if (steal) {
+            task = tasks.front();
+            tasks.pop_front();
+        } else {
+            task = tasks.back();
+            tasks.pop_back();
+        }
+        return true;
+    }
+
+    bool run_one(size_t q)
+    {
+        Task task;
+        bool found = pop(q, task, false);
+        for (size_t k = 1; !found && k < queues.size(); k++) {
+            found = pop((q + k) % queues.size(), task, true);
+        }
+        if (!found) {
+            return false;
+        }
+        queued.fetch_sub(1);
+        (*task.f)(task.i);
+        task.pending->fetch_sub(1, memory_order_release);
+        return true;
+    }
+
+    void work(size_t q)
+    {
+        while (true) {
+            if (run_one(q)) {
+                continue;
+            }
+            unique_lock<mutex> lk(m);
+            cv.wait(lk, [this]() { return stop || queued.load() > 0; });
+            if (stop) {
+                return;
+            }
+        }
+    }
+
+    vector<Queue> queues;
+    vector<thread> workers;
+    atomic<int64_t> queued{0};
+    mutex m;
+    condition_variable cv;
+    bool stop = false;
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_POOL_H_
@@ -0,0 +1,58 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_PROFILE_H_
+#define TILT_BENCH_INCLUDE_TILT_PROFILE_H_
+
+#include <x86intrin.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tilt/builder/tilder.h"
+
+using namespace std;
+using namespace tilt;
+
+/* Per-operator runtime profiles.
+ *
+ * Built with -DPROFILE_OPS=ON, the pipelined benchmarks count for every stage
+ * the events it reads and writes, its calls and the TSC cycles spent in its
+ * compiled code. A stage holds one operator of the composite query and runs
+ * on a thread of its own, which owns its counters, so counting needs no
+ * synchronization. Only the staged plans (*_pipe) are profiled; the fused
+ * ones run the whole query as one stage. The counters of all partitions are
+ * summed after execute() and main.cpp prints a Profile line per operator.
+ * Without the option nothing is counted. */
+
+struct OpCounters {
+    string name;
+    int64_t events_in = 0;
+    int64_t events_out = 0;
+    int64_t calls = 0;
+    uint64_t cycles = 0;
+};
+
+// Events among the entries (from, to] of `reg`
+inline int64_t count_events(region_t* reg, idx_t from, idx_t to)
+{
+    int64_t events = 0;
+    for (auto i = from + 1; i <= to; i++) {
+        events += (reg->tl[i & reg->mask].d != 0);
+    }
+    return events;
+}
+
+// Adds the counters of `from` to those of the same operator in `into`
+inline void merge_profile(vector<OpCounters>& into, const vector<OpCounters>& from)
+{
+    if (into.empty()) {
+        into = from;
+        return;
+    }
+    for (size_t i = 0; i < from.size(); i++) {
+        into[i].events_in += from[i].events_in;
+        into[i].events_out += from[i].events_out;
+        into[i].calls += from[i].calls;
+        into[i].cycles += from[i].cycles;
+    }
+}
+
+#endif  // TILT_BENCH_INCLUDE_TILT_PROFILE_H_
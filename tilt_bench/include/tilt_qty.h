@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_arena.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -137,6 +138,106 @@ Op _LargeQty(_sym in, int64_t p, int64_t window, int64_t scale)
     return maco_op;
 }
 
+// One field of the _MovingZScore state as its own recursive stream, adding
+// f(head) and removing f(tail) as the window slides
+Op _MovingStat(_sym in, int64_t p, int64_t window, function<Expr(Expr)> f)
+{
+    auto out = _out(types::FLOAT32);
+
+    auto head = in[_pt(0)];
+    auto head_sym = _sym("head", head);
+    auto tail = in[_pt(-window)];
+    auto tail_sym = _sym("tail", tail);
+
+    auto o = out[_pt(-p)];
+    auto o_sym = _sym("o", o);
+    auto state = _ifelse(_exists(o_sym), o_sym, _f32(0));
+    auto state_sym = _sym("state", state);
+
+    auto res = state_sym
+        + _ifelse(_exists(head_sym), f(head_sym), _f32(0))
+        - _ifelse(_exists(tail_sym), f(tail_sym), _f32(0));
+    auto res_sym = _sym("res", res);
+
+    return _op(
+        _iter(0, p),
+        Params{in},
+        SymTable{
+            {head_sym, head},
+            {tail_sym, tail},
+            {o_sym, o},
+            {state_sym, state},
+            {res_sym, res}
+        },
+        _true(),
+        res_sym);
+}
+
+// _LargeQty with the z-score state stored columnar: sum, square and count are
+// written by separate operators into state regions that share one timeline,
+// and the value is read from the input directly
+Op _LargeQtyColumnar(_sym in, int64_t p, int64_t window, int64_t scale)
+{
+    auto sum_state = _sym("sum_state", tilt::Type(types::FLOAT32, _iter(0, -1)));
+    auto square_state = _sym("square_state", tilt::Type(types::FLOAT32, _iter(0, -1)));
+    auto count_state = _sym("count_state", tilt::Type(types::FLOAT32, _iter(0, -1)));
+
+    auto win = in[_win(-p * scale - window, 0)];
+    auto win_sym = _sym("win", win);
+
+    auto sum = _MovingStat(win_sym, p, window, [](Expr e) { return e; });
+    auto sum_sym = _sym("sum", sum);
+    auto square = _MovingStat(win_sym, p, window, [](Expr e) { return e * e; });
+    auto square_sym = _sym("square", square);
+    auto count = _MovingStat(win_sym, p, window, [](Expr e) { return _f32(1); });
+    auto count_sym = _sym("count", count);
+
+    auto value = win_sym[_pt(0)];
+    auto value_sym = _sym("value", value);
+    auto s = sum_sym[_pt(0)];
+    auto s_sym = _sym("s", s);
+    auto sq = square_sym[_pt(0)];
+    auto sq_sym = _sym("sq", sq);
+    auto c = count_sym[_pt(0)];
+    auto c_sym = _sym("c", c);
+    auto avg = (s_sym / c_sym);
+    auto var = (sq_sym / c_sym) - (avg * avg);
+    auto stddev = _sqrt(var);
+    auto res = _cast(types::INT8, _gt(value_sym, avg + (_f32(3) * stddev)));
+    auto res_sym = _sym("res", res);
+    auto sel = _op(
+        _iter(0, 1),
+        Params{win_sym, sum_sym, square_sym, count_sym},
+        SymTable{
+            {value_sym, value},
+            {s_sym, s},
+            {sq_sym, sq},
+            {c_sym, c},
+            {res_sym, res}
+        },
+        _exists(value_sym),
+        res_sym);
+    auto sel_sym = _sym("sel", sel);
+
+    return _op(
+        _iter(0, p * scale),
+        Params{in, sum_state, square_state, count_state},
+        SymTable{
+            {win_sym, win},
+            {sum_sym, sum},
+            {square_sym, square},
+            {count_sym, count},
+            {sel_sym, sel}
+        },
+        _true(),
+        sel_sym,
+        Aux{
+            {sum_sym, sum_state},
+            {square_sym, square_state},
+            {count_sym, count_state}
+        });
+}
+
 struct ZScore {
     float val;
     float sum;
@@ -171,21 +272,35 @@ struct StdDev {
 
 class LargeQtyBench : public Benchmark {
 public:
-    LargeQtyBench(int64_t period, int64_t window, int64_t scale, int64_t size) :
-        period(period), window(window), scale(scale), size(size)
+    LargeQtyBench(int64_t period, int64_t window, int64_t scale, int64_t size, bool columnar = false) :
+        period(period), window(window), scale(scale), size(size), columnar(columnar)
     {}
 
 private:
     Op query() final
     {
         auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        if (columnar) {
+            return _LargeQtyColumnar(in_sym, period, window, scale);
+        }
         return _LargeQty(in_sym, period, window, scale);
     }
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
-        state_reg = create_reg<ZScore>(scale);
+        in_reg = create_in_reg<float>(size);
+        auto arena = RegionArena::Get(part);
+        if (columnar) {
+            // the three fields advance together, so square and count are
+            // payload columns over the timeline of the sum state
+            state_cols[0] = arena->state<float>(scale, query(), 1);
+            for (int i = 1; i < 3; i++) {
+                field_cols[i - 1] = map_reg<float, float>(state_cols[0], [](float) { return 0.0f; });
+                state_cols[i] = &field_cols[i - 1];
+            }
+        } else {
+            state_reg = arena->state<ZScore>(scale, query(), 1);
+        }
         out_reg = create_reg<bool>(size);
 
         SynthData<float> dataset(period, size);
@@ -194,14 +309,28 @@ private:
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg, &state_reg);
+        if (columnar) {
+            auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*, region_t*, region_t*)) addr;
+            query(0, period * size, &out_reg, &in_reg, state_cols[0], state_cols[1], state_cols[2]);
+        } else {
+            auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr;
+            query(0, period * size, &out_reg, &in_reg, state_reg);
+        }
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_largeqty(&in_reg, period, window));
     }
 
     void release() final
     {
         release_reg(&in_reg);
-        release_reg(&state_reg);
+        if (columnar) {
+            release_col(&field_cols[0]);
+            release_col(&field_cols[1]);
+        }
+        RegionArena::Get(part)->reset();
         release_reg(&out_reg);
     }
 
@@ -209,17 +338,20 @@ private:
     int64_t window;
     int64_t scale;
     int64_t size;
+    bool columnar;
     region_t in_reg;
-    region_t state_reg;
+    region_t* state_reg;
+    region_t* state_cols[3]; // sum, square, count
+    region_t field_cols[2];
     region_t out_reg;
 };
 
 class ParallelLargeQtyBench : public ParallelBenchmark {
 public:
-    ParallelLargeQtyBench(int threads, int64_t period, int64_t window, int64_t scale, int64_t size)
+    ParallelLargeQtyBench(int threads, int64_t period, int64_t window, int64_t scale, int64_t size, bool columnar = false)
     {
         for (int i = 0; i < threads; i++) {
-            benchs.push_back(new LargeQtyBench(period, window, scale, size));
+            benchs.push_back(new LargeQtyBench(period, window, scale, size, columnar));
         }
     }
 };
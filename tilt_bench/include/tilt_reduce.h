@@ -0,0 +1,392 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_REDUCE_H_
+#define TILT_BENCH_INCLUDE_TILT_REDUCE_H_
+
+#include <array>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+#include "tilt_compact.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Multi-accumulator tumbling window reductions.
+ *
+ * The _red of a tumbling window folds the events one at a time into a single
+ * state, and the dependency of every step on the previous one keeps the loop
+ * scalar. Sums, counts, sums of squares, max and min are associative and
+ * commutative, so these native kernels fold a window into L independent lane
+ * states, which the compiler keeps in vector registers, and combine the
+ * lanes once per window. A reduction with several parts (the one-pass
+ * average and variance) keeps one lane array per part and folds all of them
+ * in the same pass. The kernels run in place of the compiled query; --simd
+ * picks the vector width, and scalar folds with one lane as the generated
+ * code does. Floating point sums are reassociated, so they match the
+ * sequential reference within --verify_tol. */
+
+// Parts of a reduction: a state of type S folded over the values of a window
+template<typename T, typename S>
+struct SumPart {
+    typedef S State;
+    static S init() { return 0; }
+    static S step(S s, T v) { return s + static_cast<S>(v); }
+    static S merge(S a, S b) { return a + b; }
+};
+
+template<typename T, typename S>
+struct SumSqPart {
+    typedef S State;
+    static S init() { return 0; }
+    static S step(S s, T v) { return s + static_cast<S>(v) * static_cast<S>(v); }
+    static S merge(S a, S b) { return a + b; }
+};
+
+template<typename T, typename S>
+struct CountPart {
+    typedef S State;
+    static S init() { return 0; }
+    static S step(S s, T) { return s + 1; }
+    static S merge(S a, S b) { return a + b; }
+};
+
+template<typename T>
+struct MaxPart {
+    typedef T State;
+    static T init() { return numeric_limits<T>::lowest(); }
+    static T step(T s, T v) { return (v > s) ? v : s; }
+    static T merge(T a, T b) { return (b > a) ? b : a; }
+};
+
+template<typename T>
+struct MinPart {
+    typedef T State;
+    static T init() { return numeric_limits<T>::max(); }
+    static T step(T s, T v) { return (v < s) ? v : s; }
+    static T merge(T a, T b) { return (b < a) ? b : a; }
+};
+
+// Reductions of the benchmarks: the parts folded over a window of In values,
+// the Out value made of their states and the sequential reference
+template<typename T>
+struct SumRed {
+    typedef T In;
+    typedef T Out;
+    typedef tuple<SumPart<T, T>> Parts;
+    static Out result(T sum) { return sum; }
+
+    static vector<RefEvent<Out>> ref(region_t* in, dur_t w, ts_t end) { return ref_window_sum<T>(in, w, end); }
+};
+
+template<typename T>
+struct MaxRed {
+    typedef T In;
+    typedef T Out;
+    typedef tuple<MaxPart<T>> Parts;
+    static Out result(T max) { return max; }
+
+    static vector<RefEvent<Out>> ref(region_t* in, dur_t w, ts_t end)
+    {
+        return ref_window<T, T>(in, w, end, MaxPart<T>::init(), MaxPart<T>::step);
+    }
+};
+
+template<typename T>
+struct MinRed {
+    typedef T In;
+    typedef T Out;
+    typedef tuple<MinPart<T>> Parts;
+    static Out result(T min) { return min; }
+
+    static vector<RefEvent<Out>> ref(region_t* in, dur_t w, ts_t end)
+    {
+        return ref_window<T, T>(in, w, end, MinPart<T>::init(), MinPart<T>::step);
+    }
+};
+
+// _WindowAvgOnePass
+struct AvgRed {
+    typedef float In;
+    typedef float Out;
+    typedef tuple<SumPart<float, float>, CountPart<float, float>> Parts;
+    static Out result(float sum, float count) { return sum / count; }
+
+    static vector<RefEvent<Out>> ref(region_t* in, dur_t w, ts_t end)
+    {
+        auto ref = ref_window<float, pair<float, float>>(in, w, end, {0, 0},
+            [](pair<float, float> s, float v) { return make_pair(s.first + v, s.second + 1); });
+        return ref_map(ref, [](pair<float, float> s) { return s.first / s.second; });
+    }
+};
+
+// _WindowVar64OnePass
+struct Var64Red {
+    typedef int64_t In;
+    typedef float Out;
+    typedef tuple<SumSqPart<int64_t, int64_t>, SumPart<int64_t, int64_t>, CountPart<int64_t, int64_t>> Parts;
+
+    static Out result(int64_t sum_sq, int64_t sum, int64_t count)
+    {
+        auto s = static_cast<float>(sum);
+        auto c = static_cast<float>(count);
+        return (static_cast<float>(sum_sq) - s * s / c) / c;
+    }
+
+    static vector<RefEvent<Out>> ref(region_t* in, dur_t w, ts_t end)
+    {
+        typedef tuple<int64_t, int64_t, int64_t> S;
+        auto ref = ref_window<int64_t, S>(in, w, end, S{0, 0, 0},
+            [](S s, int64_t v) { return S{get<0>(s) + v * v, get<1>(s) + v, get<2>(s) + 1}; });
+        return ref_map(ref, [](S s) { return result(get<0>(s), get<1>(s), get<2>(s)); });
+    }
+};
+
+// `keep ? a : b` without a branch. Integer states blend through a bit mask,
+// as GCC 12 vectorizes the select of int64 lanes on a strided compare wrongly.
+template<typename S>
+__attribute__((always_inline)) inline S lane_select(bool keep, S a, S b)
+{
+    if constexpr (is_integral<S>::value) {
+        auto m = static_cast<S>(-static_cast<S>(keep));
+        return static_cast<S>((a & m) | (b & ~m));
+    } else {
+        return keep ? a : b;
+    }
+}
+
+// Window of the tumbling kernels of R, set by compile() as the generated code
+// has its window built in
+template<typename R>
+inline dur_t tumble_window = 0;
+
+// Folds spans of a window into L lanes of every part of R
+template<typename R, int L, typename Seq = make_index_sequence<tuple_size<typename R::Parts>::value>>
+struct Lanes;
+
+template<typename R, int L, size_t... I>
+struct Lanes<R, L, index_sequence<I...>> {
+    typedef typename R::In T;
+    template<size_t K> using Part = typename tuple_element<K, typename R::Parts>::type;
+
+    __attribute__((always_inline)) inline void init()
+    {
+        ((get<I>(acc).fill(Part<I>::init())), ...);
+    }
+
+    // folds the data entries of n consecutive slots
+    __attribute__((always_inline)) inline void fold(const ival_t* tl, const T* v, idx_t n)
+    {
+        idx_t i = 0;
+        for (; i + L <= n; i += L) {
+            for (int l = 0; l < L; l++) {
+                bool keep = tl[i + l].d != 0;
+                ((get<I>(acc)[l] = lane_select(keep, Part<I>::step(get<I>(acc)[l], v[i + l]), get<I>(acc)[l])), ...);
+            }
+        }
+        for (; i < n; i++) {
+            if (tl[i].d != 0) {
+                ((get<I>(acc)[0] = Part<I>::step(get<I>(acc)[0], v[i])), ...);
+            }
+        }
+    }
+
+    // combines the lanes of every part
+    __attribute__((always_inline)) inline typename R::Out result()
+    {
+        return R::result(merge<I>()...);
+    }
+
+    template<size_t K>
+    __attribute__((always_inline)) inline typename Part<K>::State merge()
+    {
+        auto s = get<K>(acc)[0];
+        for (int l = 1; l < L; l++) {
+            s = Part<K>::merge(s, get<K>(acc)[l]);
+        }
+        return s;
+    }
+
+    tuple<array<typename Part<I>::State, L>...> acc;
+};
+
+// First entry of `reg` from `i` on ending after `t`, galloping from `i` since
+// the next window end is close
+inline idx_t tumble_next(region_t* reg, idx_t i, ts_t t)
+{
+    auto end = get_end_idx(reg) + 1;
+    auto ends_by = [reg, t](idx_t j) { return reg->tl[j & reg->mask].t + reg->tl[j & reg->mask].d <= t; };
+    idx_t lo = i;
+    idx_t step = 1;
+    while (lo + step <= end && ends_by(lo + step - 1)) {
+        lo += step;
+        step *= 2;
+    }
+    auto hi = min(lo + step - 1, end);
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+        if (ends_by(mid)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// One output per window (t - w, t] for every window end t in (t_start, t_end]
+template<typename R, int L>
+__attribute__((always_inline)) inline region_t* tumble(ts_t t_start, ts_t t_end, region_t* out, region_t* in)
+{
+    typedef typename R::In T;
+    auto w = tumble_window<R>;
+    auto t = (t_start / w + 1) * w;
+    auto i = where_first(in, t - w);
+    Lanes<R, L> lanes;
+    for (; t <= t_end; t += w) {
+        auto next = tumble_next(in, i, t);
+        lanes.init();
+        while (i < next) {
+            auto p = i & in->mask;
+            auto n = min<idx_t>(next - i, in->mask + 1 - p);
+            lanes.fold(in->tl + p, reinterpret_cast<T*>(in->data) + p, n);
+            i += n;
+        }
+        commit_data(out, t);
+        *reinterpret_cast<typename R::Out*>(fetch(out, t, get_end_idx(out), sizeof(typename R::Out))) = lanes.result();
+    }
+    return out;
+}
+
+// Lanes filling two vector registers with input values
+template<typename R>
+constexpr int tumble_lanes(int vec_bytes)
+{
+    return 2 * vec_bytes / sizeof(typename R::In);
+}
+
+template<typename R>
+region_t* tumble_scalar(ts_t t_start, ts_t t_end, region_t* out, region_t* in)
+{
+    return tumble<R, 1>(t_start, t_end, out, in);
+}
+
+template<typename R>
+__attribute__((target("avx2")))
+region_t* tumble_avx2(ts_t t_start, ts_t t_end, region_t* out, region_t* in)
+{
+    return tumble<R, tumble_lanes<R>(32)>(t_start, t_end, out, in);
+}
+
+template<typename R>
+__attribute__((target("avx512f,avx512bw")))
+region_t* tumble_avx512(ts_t t_start, ts_t t_end, region_t* out, region_t* in)
+{
+    return tumble<R, tumble_lanes<R>(64)>(t_start, t_end, out, in);
+}
+
+template<typename R>
+class TumbleBench : public Benchmark {
+public:
+    typedef typename R::In In;
+    typedef typename R::Out Out;
+
+    TumbleBench(dur_t period, int64_t size, int64_t w) :
+        period(period), size(size), w(w)
+    {}
+
+    bool partitionable() override { return true; }
+
+    bool native() override { return true; }
+
+    // no TiLT query to compile, the kernel takes the place of the compiled code
+    intptr_t compile() override
+    {
+        tumble_window<R> = w;
+        switch (simd_level()) {
+            case SimdLevel::AVX512:
+                return reinterpret_cast<intptr_t>(&tumble_avx512<R>);
+            case SimdLevel::AVX2:
+                return reinterpret_cast<intptr_t>(&tumble_avx2<R>);
+            default:
+                return reinterpret_cast<intptr_t>(&tumble_scalar<R>);
+        }
+    }
+
+private:
+    Op query() final
+    {
+        throw runtime_error("Tumbling reduction kernels have no TiLT query");
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<In>(size);
+        out_reg = create_out_reg<Out>(ceil((double) size / w), size);
+
+        SynthData<In> dataset(period, size);
+        dataset.fill(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        run_query(addr, period * size, size, w, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, R::ref(&in_reg, w, period * size));
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    dur_t period;
+    int64_t size;
+    int64_t w;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+// Runs testcase vec<query> with query one of aggregate, sum64, sum8,
+// avgonepass and var64onepass, the kernels of the compiled testcases of the
+// same name, and max and min over float
+class ParallelTumbleBench : public ParallelBenchmark {
+public:
+    ParallelTumbleBench(int threads, const string& testcase, dur_t period, int64_t size, int64_t w)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(make(testcase, period, size, w));
+        }
+    }
+
+private:
+    static Benchmark* make(const string& testcase, dur_t period, int64_t size, int64_t w)
+    {
+        if (testcase == "vecaggregate") {
+            return new TumbleBench<SumRed<float>>(period, size, w);
+        } else if (testcase == "vecsum64") {
+            return new TumbleBench<SumRed<int64_t>>(period, size, w);
+        } else if (testcase == "vecsum8") {
+            return new TumbleBench<SumRed<int8_t>>(period, size, w);
+        } else if (testcase == "vecmax") {
+            return new TumbleBench<MaxRed<float>>(period, size, w);
+        } else if (testcase == "vecmin") {
+            return new TumbleBench<MinRed<float>>(period, size, w);
+        } else if (testcase == "vecavgonepass") {
+            return new TumbleBench<AvgRed>(period, size, w);
+        } else if (testcase == "vecvar64onepass") {
+            return new TumbleBench<Var64Red>(period, size, w);
+        }
+        throw runtime_error("Invalid tumbling reduction " + testcase);
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_REDUCE_H_
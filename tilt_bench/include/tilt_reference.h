@@ -0,0 +1,564 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_REFERENCE_H_
+#define TILT_BENCH_INCLUDE_TILT_REFERENCE_H_
+
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_sink.h"
+
+using namespace std;
+
+/* Scalar reference implementations of the TiLT queries, used by --verify.
+ *
+ * Every reference takes the input region of a benchmark and returns the data
+ * entries the query should produce as (end time, value) pairs. They follow
+ * the definition of the query over one continuous stream, so they also catch
+ * results that depend on how the code generator splits the stream into
+ * windows. The references of queries built from _pt lookups (rsi, pantom,
+ * algotrading, largeqty) index events by t / period and need a dense periodic
+ * input, which is what those benchmarks generate. */
+
+// Set once from main.cpp: --verify=<0|1> and --verify_tol=<relative tolerance>
+inline bool verify_output = false;
+inline double verify_tol = 1e-4;
+
+template<typename T>
+struct RefEvent {
+    ts_t t;
+    T v;
+};
+
+// Result of comparing an output region with its reference
+struct Verdict {
+    bool checked = false;
+    int64_t entries = 0;
+    int64_t mismatches = 0;
+    uint64_t checksum = kFNVBasis;
+};
+
+template<typename T>
+vector<RefEvent<T>> ref_input(region_t* reg)
+{
+    vector<RefEvent<T>> events;
+    for (auto i = get_start_idx(reg); i <= get_end_idx(reg); i++) {
+        auto iv = reg->tl[i & reg->mask];
+        if (iv.d > 0) {
+            auto t = iv.t + iv.d;
+            events.push_back(RefEvent<T>{t, *reinterpret_cast<T*>(fetch(reg, t, i, sizeof(T)))});
+        }
+    }
+    return events;
+}
+
+// Payload values of a dense periodic input, the i-th one ending at (i + 1) * period
+template<typename T>
+vector<T> ref_values(region_t* reg)
+{
+    vector<T> vals;
+    for (auto& e : ref_input<T>(reg)) {
+        vals.push_back(e.v);
+    }
+    return vals;
+}
+
+// Integers compare exactly, floats and structs of floats within the relative
+// tolerance, with NaNs equal to each other
+inline bool ref_equal(float a, float b)
+{
+    if (isnan(a) || isnan(b)) {
+        return isnan(a) && isnan(b);
+    }
+    if (a == b) {
+        return true;
+    }
+    return fabs(a - b) <= verify_tol * max(1.0f, max(fabs(a), fabs(b)));
+}
+
+template<typename T>
+bool ref_equal(const T& a, const T& b)
+{
+    if constexpr (is_integral<T>::value) {
+        return a == b;
+    } else {
+        static_assert(sizeof(T) % sizeof(float) == 0, "Only float structs are compared field-wise");
+        auto fa = reinterpret_cast<const float*>(&a);
+        auto fb = reinterpret_cast<const float*>(&b);
+        for (size_t i = 0; i < sizeof(T) / sizeof(float); i++) {
+            if (!ref_equal(fa[i], fb[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// Streams the data entries of `out` against `ref` by end time, counting
+// entries missing on either side and values that differ. The checksum covers
+// the end time and payload of every output entry.
+template<typename T>
+Verdict ref_compare(region_t* out, const vector<RefEvent<T>>& ref)
+{
+    Verdict res;
+    res.checked = true;
+    size_t j = 0;
+    for (auto i = get_start_idx(out); i <= get_end_idx(out); i++) {
+        auto iv = out->tl[i & out->mask];
+        if (iv.d == 0) {
+            continue;
+        }
+        auto t = iv.t + iv.d;
+        auto v = *reinterpret_cast<T*>(fetch(out, t, i, sizeof(T)));
+        res.entries++;
+        res.checksum = fnv1a(res.checksum, &t, sizeof(ts_t));
+        res.checksum = fnv1a(res.checksum, &v, sizeof(T));
+
+        while (j < ref.size() && ref[j].t < t) {
+            res.mismatches++;
+            j++;
+        }
+        if (j < ref.size() && ref[j].t == t) {
+            res.mismatches += !ref_equal(v, ref[j].v);
+            j++;
+        } else {
+            res.mismatches++;
+        }
+    }
+    res.mismatches += ref.size() - j;
+    return res;
+}
+
+template<typename T, typename U, typename F>
+vector<RefEvent<U>> ref_select(region_t* in, F f)
+{
+    vector<RefEvent<U>> out;
+    for (auto& e : ref_input<T>(in)) {
+        out.push_back(RefEvent<U>{e.t, f(e.v)});
+    }
+    return out;
+}
+
+template<typename T, typename F>
+vector<RefEvent<T>> ref_where(region_t* in, F filter)
+{
+    vector<RefEvent<T>> out;
+    for (auto& e : ref_input<T>(in)) {
+        if (filter(e.v)) {
+            out.push_back(e);
+        }
+    }
+    return out;
+}
+
+// Tumbling window reduction: one output per window (n * w - w, n * w] up to
+// `end`, folding acc(state, value) over the events of the window in order
+template<typename T, typename S, typename Acc>
+vector<RefEvent<S>> ref_window(region_t* in, dur_t w, ts_t end, S init, Acc acc)
+{
+    auto events = ref_input<T>(in);
+    vector<RefEvent<S>> out;
+    size_t i = 0;
+    for (ts_t t = w; t <= end; t += w) {
+        auto s = init;
+        for (; i < events.size() && events[i].t <= t; i++) {
+            s = acc(s, events[i].v);
+        }
+        out.push_back(RefEvent<S>{t, s});
+    }
+    return out;
+}
+
+template<typename T>
+vector<RefEvent<T>> ref_window_sum(region_t* in, dur_t w, ts_t end)
+{
+    return ref_window<T, T>(in, w, end, 0, [](T s, T v) -> T { return s + v; });
+}
+
+// Sums over (t - w, t] at every t = k * stride up to `end`
+template<typename T>
+vector<RefEvent<T>> ref_sliding_sum(region_t* in, dur_t w, dur_t stride, ts_t end)
+{
+    auto events = ref_input<T>(in);
+    vector<RefEvent<T>> out;
+    size_t first = 0, last = 0;
+    for (ts_t t = stride; t <= end; t += stride) {
+        while (first < events.size() && events[first].t <= t - w) {
+            first++;
+        }
+        while (last < events.size() && events[last].t <= t) {
+            last++;
+        }
+        T s = 0;
+        for (auto i = first; i < last; i++) {
+            s = s + events[i].v;
+        }
+        out.push_back(RefEvent<T>{t, s});
+    }
+    return out;
+}
+
+// Tumbling window sums of the windows holding events only
+template<typename T>
+vector<RefEvent<T>> ref_tumble_sum(region_t* in, dur_t w)
+{
+    auto events = ref_input<T>(in);
+    vector<RefEvent<T>> out;
+    size_t i = 0;
+    while (i < events.size()) {
+        auto t = ((events[i].t + w - 1) / w) * w;
+        T s = 0;
+        for (; i < events.size() && events[i].t <= t; i++) {
+            s = s + events[i].v;
+        }
+        out.push_back(RefEvent<T>{t, s});
+    }
+    return out;
+}
+
+template<typename T, typename F>
+auto ref_map(const vector<RefEvent<T>>& in, F f)
+{
+    vector<RefEvent<decltype(f(in[0].v))>> out;
+    for (auto& e : in) {
+        out.push_back({e.t, f(e.v)});
+    }
+    return out;
+}
+
+// Calls f(first, last, t) for the events [first, last) of every tumbling window
+template<typename T, typename F>
+void ref_tumble(const vector<RefEvent<T>>& events, dur_t w, F f)
+{
+    size_t i = 0;
+    while (i < events.size()) {
+        auto t = ((events[i].t + w - 1) / w) * w;
+        auto j = i;
+        while (j < events.size() && events[j].t <= t) {
+            j++;
+        }
+        f(i, j, t);
+        i = j;
+    }
+}
+
+// _Norm: every event standardized by the mean and deviation of its window
+inline vector<RefEvent<float>> ref_norm(region_t* in, dur_t window)
+{
+    auto events = ref_input<float>(in);
+    vector<RefEvent<float>> out;
+    ref_tumble(events, window, [&](size_t first, size_t last, ts_t) {
+        float sum = 0, count = 0;
+        for (auto i = first; i < last; i++) {
+            sum += events[i].v;
+            count += 1;
+        }
+        auto avg = sum / count;
+        float sq = 0;
+        for (auto i = first; i < last; i++) {
+            auto d = events[i].v - avg;
+            sq += d * d;
+        }
+        auto dev = sqrt(sq / count);
+        for (auto i = first; i < last; i++) {
+            out.push_back(RefEvent<float>{events[i].t, (events[i].v - avg) / dev});
+        }
+    });
+    return out;
+}
+
+// _Norm64OnePass: _Norm over int64 events, with the deviation taken from the
+// exact sums of the window in one pass
+inline vector<RefEvent<float>> ref_norm64(region_t* in, dur_t window)
+{
+    auto events = ref_input<int64_t>(in);
+    vector<RefEvent<float>> out;
+    ref_tumble(events, window, [&](size_t first, size_t last, ts_t) {
+        int64_t sq = 0, sum = 0, count = 0;
+        for (auto i = first; i < last; i++) {
+            sq += events[i].v * events[i].v;
+            sum += events[i].v;
+            count += 1;
+        }
+        auto fsq = static_cast<float>(sq), fsum = static_cast<float>(sum), fcount = static_cast<float>(count);
+        auto avg = fsum / fcount;
+        auto sd = sqrt((fsq - ((fsum * fsum) / fcount)) / fcount);
+        for (auto i = first; i < last; i++) {
+            out.push_back(RefEvent<float>{events[i].t, (static_cast<float>(events[i].v) - avg) / sd});
+        }
+    });
+    return out;
+}
+
+// _Kurt: kurtosis, rms and crest factor of the window of every event
+template<typename K>
+vector<RefEvent<K>> ref_kurt(region_t* in, dur_t window)
+{
+    auto events = ref_input<float>(in);
+    vector<RefEvent<K>> out;
+    ref_tumble(events, window, [&](size_t first, size_t last, ts_t) {
+        float mx = 0, sum = 0, count = 0, sq = 0;
+        for (auto i = first; i < last; i++) {
+            auto d = events[i].v;
+            mx = max(mx, d);
+            sum += d;
+            count += 1;
+            sq += d * d;
+        }
+        auto avg = sum / count;
+        auto rms = sqrt(sq / count);
+        auto cf = mx / rms;
+        float kurt = 0;
+        for (auto i = first; i < last; i++) {
+            auto d = events[i].v - avg;
+            kurt += d * d * d * d;
+        }
+        auto pow4 = rms * rms * rms * rms;
+        for (auto i = first; i < last; i++) {
+            out.push_back(RefEvent<K>{events[i].t, K{kurt / pow4, rms, cf, 0}});
+        }
+    });
+    return out;
+}
+
+// Value `back` events before i of a dense stream, or 0 if there is none
+template<typename T>
+T ref_at(const vector<T>& v, int64_t i, int64_t back)
+{
+    return (i - back >= 0) ? v[i - back] : 0;
+}
+
+// _RSICalc over a `window` tick moving window of price differences
+inline vector<RefEvent<float>> ref_rsi(region_t* in, dur_t p, int64_t window)
+{
+    auto vals = ref_values<float>(in);
+    int64_t n = vals.size(), back = window / p;
+    vector<float> diff(n);
+    vector<RefEvent<float>> out;
+    float pos = 0, neg = 0;
+    for (int64_t i = 0; i < n; i++) {
+        diff[i] = (i > 0) ? vals[i - 1] - vals[i] : 0;
+        auto head = diff[i];
+        auto tail = ref_at(diff, i, back);
+        pos = (pos + ((head > 0) ? head : 0)) - ((tail > 0) ? tail : 0);
+        neg = (neg + ((head < 0) ? -head : 0)) - ((tail < 0) ? -tail : 0);
+        out.push_back(RefEvent<float>{(i + 1) * p, 100 - (100 / (1 + (pos / neg)))});
+    }
+    return out;
+}
+
+// _MACrossOver: 1 while the short moving average is above the long one
+inline vector<RefEvent<int8_t>> ref_moca(region_t* in, dur_t p, int64_t w_short, int64_t w_long)
+{
+    auto vals = ref_values<float>(in);
+    int64_t n = vals.size(), bs = w_short / p, bl = w_long / p;
+    vector<RefEvent<int8_t>> out;
+    float ssum = 0, scount = 0, lsum = 0, lcount = 0;
+    for (int64_t i = 0; i < n; i++) {
+        ssum = (ssum + vals[i]) - ref_at(vals, i, bs);
+        lsum = (lsum + vals[i]) - ref_at(vals, i, bl);
+        scount = (scount + 1) - ((i >= bs) ? 1 : 0);
+        lcount = (lcount + 1) - ((i >= bl) ? 1 : 0);
+        out.push_back(RefEvent<int8_t>{(i + 1) * p, (ssum / scount) > (lsum / lcount)});
+    }
+    return out;
+}
+
+// _PanTom: low pass, high pass, derivative and moving average of squares
+inline vector<RefEvent<float>> ref_pantom(region_t* in, dur_t p, int64_t window)
+{
+    auto x = ref_values<float>(in);
+    int64_t n = x.size(), back = window / p;
+    vector<float> lp(n), hp(n), derv(n);
+    vector<RefEvent<float>> out;
+    float sum = 0, count = 0;
+    for (int64_t i = 0; i < n; i++) {
+        lp[i] = (2.0f * ref_at(lp, i, 1)) - ref_at(lp, i, 2) + x[i] - (2.0f * ref_at(x, i, 6)) + ref_at(x, i, 12);
+        hp[i] = (32.0f * ref_at(lp, i, 16)) - ref_at(hp, i, 1) + lp[i] - ref_at(lp, i, 32);
+        derv[i] = static_cast<float>(p / 8)
+            * (hp[i] + (2.0f * ref_at(hp, i, 1)) - (2.0f * ref_at(hp, i, 3)) - ref_at(hp, i, 4));
+        auto tail = ref_at(derv, i, back);
+        sum = (sum + derv[i] * derv[i]) - tail * tail;
+        count = (count + 1) - ((i >= back) ? 1 : 0);
+        out.push_back(RefEvent<float>{(i + 1) * p, sum / count});
+    }
+    return out;
+}
+
+// _LargeQty: 1 for values more than three deviations above the moving mean
+inline vector<RefEvent<int8_t>> ref_largeqty(region_t* in, dur_t p, int64_t window)
+{
+    auto vals = ref_values<float>(in);
+    int64_t n = vals.size(), back = window / p;
+    vector<RefEvent<int8_t>> out;
+    float sum = 0, square = 0, count = 0;
+    for (int64_t i = 0; i < n; i++) {
+        auto head = vals[i];
+        auto tail = ref_at(vals, i, back);
+        sum = (sum + head) - tail;
+        square = (square + head * head) - tail * tail;
+        count = (count + 1) - ((i >= back) ? 1 : 0);
+        auto avg = sum / count;
+        auto var = (square / count) - (avg * avg);
+        out.push_back(RefEvent<int8_t>{(i + 1) * p, head > avg + (3.0f * sqrt(var))});
+    }
+    return out;
+}
+
+// Slots of a periodic input with gaps, the i-th one ending at (i + 1) * period
+struct RefSlots {
+    vector<bool> present;
+    vector<float> vals;
+    // last present slot at or before i, or -1
+    vector<int64_t> prev;
+    // first present slot at or after i, or the slot count
+    vector<int64_t> next;
+};
+
+inline RefSlots ref_slots(region_t* in, dur_t p, int64_t n)
+{
+    RefSlots s{vector<bool>(n, false), vector<float>(n, 0), vector<int64_t>(n), vector<int64_t>(n)};
+    for (auto& e : ref_input<float>(in)) {
+        auto i = e.t / p - 1;
+        if (i >= 0 && i < n) {
+            s.present[i] = true;
+            s.vals[i] = e.v;
+        }
+    }
+    for (int64_t i = 0, last = -1; i < n; i++) {
+        last = s.present[i] ? i : last;
+        s.prev[i] = last;
+    }
+    for (int64_t i = n - 1, first = n; i >= 0; i--) {
+        first = s.present[i] ? i : first;
+        s.next[i] = first;
+    }
+    return s;
+}
+
+// _Impute: every tick of a window holding events carries the value of the
+// event covering it, or else the mean of the window
+inline vector<RefEvent<float>> ref_fillmean(region_t* in, dur_t p, dur_t window, int64_t n)
+{
+    auto s = ref_slots(in, p, n);
+    vector<RefEvent<float>> out;
+    for (ts_t end = window; end <= n * p; end += window) {
+        float sum = 0, count = 0;
+        for (auto i = (end - window) / p; i < end / p; i++) {
+            if (s.present[i]) {
+                sum += s.vals[i];
+                count += 1;
+            }
+        }
+        if (count == 0) {
+            continue;
+        }
+        for (auto t = end - window + 1; t <= end; t++) {
+            auto i = (t - 1) / p;
+            out.push_back(RefEvent<float>{t, s.present[i] ? s.vals[i] : sum / count});
+        }
+    }
+    return out;
+}
+
+// _ForwardFill: at every period from the first present event on, the last
+// present value
+inline vector<RefEvent<float>> ref_ffill(region_t* in, dur_t p, int64_t n)
+{
+    auto s = ref_slots(in, p, n);
+    vector<RefEvent<float>> out;
+    for (int64_t i = 0; i < n; i++) {
+        if (s.prev[i] >= 0) {
+            out.push_back(RefEvent<float>{(i + 1) * p, s.vals[s.prev[i]]});
+        }
+    }
+    return out;
+}
+
+// _BackwardFill: at every period the slot `horizon` ticks back, or else the
+// first present slot after it up to now
+inline vector<RefEvent<float>> ref_bfill(region_t* in, dur_t p, dur_t horizon, int64_t n)
+{
+    auto s = ref_slots(in, p, n);
+    auto h = horizon / p;
+    vector<RefEvent<float>> out;
+    for (int64_t i = 0; i < n; i++) {
+        auto slot = i - h;
+        auto from = max<int64_t>(slot + 1, 0);
+        auto next = (from < n) ? s.next[from] : n;
+        if (slot >= 0 && s.present[slot]) {
+            out.push_back(RefEvent<float>{(i + 1) * p, s.vals[slot]});
+        } else if (next <= i) {
+            out.push_back(RefEvent<float>{(i + 1) * p, s.vals[next]});
+        }
+    }
+    return out;
+}
+
+// _LinearInterp: at every period the slot `horizon` ticks back, or else the
+// line between the present slots around it, each at most `horizon` away
+inline vector<RefEvent<float>> ref_interp(region_t* in, dur_t p, dur_t horizon, int64_t n)
+{
+    auto s = ref_slots(in, p, n);
+    auto h = horizon / p;
+    vector<RefEvent<float>> out;
+    for (int64_t i = 0; i < n; i++) {
+        auto slot = i - h;
+        if (slot >= 0 && s.present[slot]) {
+            out.push_back(RefEvent<float>{(i + 1) * p, s.vals[slot]});
+            continue;
+        }
+        auto prev = (slot >= 0) ? s.prev[slot] : -1;
+        auto from = max<int64_t>(slot + 1, 0);
+        auto next = (from < n) ? s.next[from] : n;
+        if (prev < 0 || prev <= slot - h || next > i) {
+            continue;
+        }
+        auto pv = s.vals[prev], nv = s.vals[next];
+        ts_t pt = (prev + 1) * p, nt = (next + 1) * p, t = (slot + 1) * p;
+        auto frac = static_cast<float>(t - pt) / static_cast<float>(nt - pt);
+        out.push_back(RefEvent<float>{(i + 1) * p, pv + ((nv - pv) * frac)});
+    }
+    return out;
+}
+
+// _Resample: at every output period up to `end`, the line through the input
+// values of the input period covering it and the one before
+inline vector<RefEvent<float>> ref_resample(region_t* in, dur_t ip, dur_t op, ts_t end)
+{
+    auto vals = ref_values<float>(in);
+    int64_t n = vals.size();
+    vector<RefEvent<float>> out;
+    for (ts_t t = op; t <= end; t += op) {
+        auto k = (t + ip - 1) / ip;
+        if (k < 2 || k > n) {
+            continue;
+        }
+        auto sv = vals[k - 2], ev = vals[k - 1];
+        auto et = static_cast<float>(k * ip);
+        auto st = et - static_cast<float>(ip);
+        out.push_back(RefEvent<float>{t, (((ev - sv) * (static_cast<float>(t) - st)) / (et - st)) + sv});
+    }
+    return out;
+}
+
+// _Join of two streams: f(left, right) wherever events of both end together
+template<typename T, typename F>
+vector<RefEvent<T>> ref_join(region_t* left, region_t* right, F f)
+{
+    auto l = ref_input<T>(left);
+    auto r = ref_input<T>(right);
+    vector<RefEvent<T>> out;
+    size_t j = 0;
+    for (auto& e : l) {
+        while (j < r.size() && r[j].t < e.t) {
+            j++;
+        }
+        if (j < r.size() && r[j].t == e.t) {
+            out.push_back(RefEvent<T>{e.t, f(e.v, r[j].v)});
+        }
+    }
+    return out;
+}
+
+#endif  // TILT_BENCH_INCLUDE_TILT_REFERENCE_H_
@@ -0,0 +1,601 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_REGISTRY_H_
+#define TILT_BENCH_INCLUDE_TILT_REGISTRY_H_
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "tilt_bench.h"
+#include "tilt_select.h"
+#include "tilt_where.h"
+#include "tilt_aggregate.h"
+#include "tilt_sumwhere.h"
+#include "tilt_average.h"
+#include "tilt_var.h"
+#include "tilt_alterdur.h"
+#include "tilt_sliding_sum.h"
+#include "tilt_innerjoin.h"
+#include "tilt_outerjoin.h"
+#include "tilt_norm.h"
+#include "tilt_ma.h"
+#include "tilt_rsi.h"
+#include "tilt_keyed.h"
+#include "tilt_qty.h"
+#include "tilt_impute.h"
+#include "tilt_peak.h"
+#include "tilt_resample.h"
+#include "tilt_kurt.h"
+#include "tilt_eg.h"
+#include "tilt_yahoo.h"
+#include "bd_tilt_select.h"
+#include "bd_tilt_where.h"
+#include "tilt_compress.h"
+#include "tilt_implicit.h"
+#include "tilt_openloop.h"
+#include "tilt_pipeline.h"
+#include "tilt_reorder.h"
+#include "tilt_width.h"
+#include "tilt_compact.h"
+#include "tilt_reduce.h"
+#include "tilt_fuse.h"
+
+using namespace std;
+
+/* Benchmark registry and in-process parameter sweeps.
+ *
+ * Every testcase of main.cpp is registered here with the query parameters it
+ * declares and their defaults. A single run takes them from flags of the same
+ * name (--w=500), a sweep from its spec:
+ *
+ *   ./build/main sweep --spec=<file or inline spec> [--format=csv|json] [--out=<file>]
+ *
+ * A spec has one `key=v1,v2,...` line per dimension (lines may also be
+ * separated by ';'): `testcase` names registered benchmarks, `size`,
+ * `threads` and `period` apply to all of them and any other key is a query
+ * parameter. Every testcase runs over the cross product of the dimensions it
+ * declares, with its defaults for the rest. A query is compiled once per
+ * distinct generated code, which depends on its parameters and, for some
+ * queries, on the period or the size; threads never change the code. */
+
+// Fraction of the input slots left empty by the imputation and implicit
+// timeline testcases, set once from the main.cpp flag --missing
+inline double missing_ratio = 0;
+
+struct SweepPoint {
+    string testcase;
+    dur_t period;
+    int64_t size;
+    int threads;
+    map<string, int64_t> params;
+};
+
+// What a run of a registered testcase reports
+struct BenchResult {
+    int64_t time_us = 0;
+    int64_t compile_us = 0;
+    bool reused = false;
+    int64_t out_count = 0;
+    uint64_t out_checksum = 0;
+    Verdict verdict;
+    LatencyHistogram latency;
+    int64_t batch_events = 0;
+    TierStats tier;
+    vector<OpCounters> profile;
+    int64_t in_bytes = 0;
+
+    // filled by the stats of the testcases reporting them
+    bool open_loop = false;
+    int64_t payload_bytes = 0;
+    int64_t timeline_bytes = 0;
+    int64_t fused_bytes = 0;
+    int64_t ring_bytes = 0;
+};
+
+struct BenchEntry {
+    // query parameters with their defaults
+    vector<pair<string, int64_t>> params;
+    // whether the generated code depends on the period
+    bool period_in_code;
+    function<ParallelBenchmark*(const SweepPoint&)> make;
+    // collects the results only this testcase reports
+    function<void(ParallelBenchmark*, BenchResult&)> stats = nullptr;
+    // whether the generated code depends on the size
+    bool size_in_code = false;
+};
+
+// Runs a benchmark that has no parallel variant on one thread
+class SingleBench : public ParallelBenchmark {
+public:
+    explicit SingleBench(Benchmark* bench) { benchs.push_back(bench); }
+};
+
+template<typename T>
+void register_compress(map<string, BenchEntry>& reg, const string& bits)
+{
+    vector<pair<string, CompOp>> ops = {{"select", CompOp::SELECT}, {"where", CompOp::WHERE}, {"sum", CompOp::SUM}};
+    for (auto& op : ops) {
+        auto comp_op = op.second;
+        reg["for" + op.first + bits] = {{{"block", 64}, {"w", 1000}}, true, [comp_op](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelFORBench<T, int8_t>(p.threads, comp_op, p.period, p.params.at("block"),
+                p.params.at("w") * p.period, p.size);
+        }};
+        reg["packed" + op.first + bits] = {{{"block", 64}, {"w", 1000}}, true, [comp_op](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelPackedBench<T>(p.threads, comp_op, p.period, p.params.at("block"),
+                p.params.at("w") * p.period, p.size);
+        }};
+    }
+}
+
+template<typename T>
+void register_implicit(map<string, BenchEntry>& reg, const string& bits)
+{
+    vector<pair<string, CompOp>> ops = {{"select", CompOp::SELECT}, {"where", CompOp::WHERE}, {"sum", CompOp::SUM}};
+    for (auto& op : ops) {
+        auto comp_op = op.second;
+        reg["implicit" + op.first + bits] = {{{"w", 1000}, {"burst", 1}}, true, [comp_op](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelImplicitBench<T>(p.threads, comp_op, p.period, p.params.at("w") * p.period, p.size,
+                missing_ratio, p.params.at("burst"));
+        }};
+        reg["explicit" + op.first + bits] = {{{"w", 1000}, {"burst", 1}}, true, [comp_op](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelExplicitBench<T>(p.threads, comp_op, p.period, p.params.at("w") * p.period, p.size,
+                missing_ratio, p.params.at("burst"));
+        }};
+    }
+}
+
+map<string, BenchEntry> bench_registry()
+{
+    map<string, BenchEntry> reg;
+    reg["select"] = {{}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelSelectBench(p.threads, p.period, p.size);
+    }};
+    reg["select64"] = {{}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelSelect64Bench(p.threads, p.period, p.size);
+    }};
+    reg["select8"] = {{}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelSelect8Bench(p.threads, p.period, p.size);
+    }};
+    reg["where"] = {{}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelWhereBench(p.threads, p.period, p.size);
+    }};
+    reg["where64"] = {{}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelWhere64Bench(p.threads, p.period, p.size);
+    }};
+    reg["where8"] = {{}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelWhere8Bench(p.threads, p.period, p.size);
+    }};
+    // tumbling windows of `w` events
+    reg["aggregate"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelAggregateBench(p.threads, p.period, p.size, p.params.at("w") * p.period);
+    }};
+    reg["sum64"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelSum64Bench(p.threads, p.period, p.size, p.params.at("w") * p.period);
+    }};
+    reg["sum8"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelSum8Bench(p.threads, p.period, p.size, p.params.at("w") * p.period);
+    }};
+    reg["sumwhere"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelSumWhere64Bench(p.threads, p.period, p.size, p.params.at("w") * p.period);
+    }};
+    reg["var64onepass"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelVar64OnePassBench(p.threads, p.period, p.params.at("w") * p.period, p.size);
+    }};
+    reg["avg"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelAverageBench(p.threads, p.period, p.size, p.params.at("w") * p.period);
+    }};
+    reg["avgonepass"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelAverageOnePassBench(p.threads, p.period, p.size, p.params.at("w") * p.period);
+    }};
+    reg["norm64onepass"] = {{{"w", 1000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelNorm64OnePassBench(p.threads, p.period, p.params.at("w") * p.period, p.size);
+    }};
+    reg["yahoo"] = {{{"w", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelYahooBench(p.threads, p.period, p.params.at("w") * p.period, p.size);
+    }};
+    reg["yahoo_col"] = {{{"w", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelYahooBench(p.threads, p.period, p.params.at("w") * p.period, p.size, YahooLayout::COLUMNAR);
+    }};
+    reg["yahoo_dict"] = {{{"w", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelYahooBench(p.threads, p.period, p.params.at("w") * p.period, p.size, YahooLayout::DICT);
+    }};
+    reg["yahoo_dict_col"] = {{{"w", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelYahooBench(p.threads, p.period, p.params.at("w") * p.period, p.size,
+            YahooLayout::DICT_COLUMNAR);
+    }};
+    reg["bdselect"] = {{{"w", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelBDSelectBench(p.threads, p.period, p.params.at("w") * p.period, p.size);
+    }};
+    reg["bdwhere"] = {{{"w", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelBDWhereBench(p.threads, p.period, p.params.at("w") * p.period, p.size);
+    }};
+    reg["naivesum"] = {{}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelNaiveSlidingSumBench(p.threads, p.period, p.size);
+    }};
+    // one window over the whole input
+    reg["incsum"] = {{}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelIncSlidingSumBench(p.threads, p.period, p.size);
+    }, nullptr, true};
+    reg["innerjoin"] = {{}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new SingleBench(new InnerJoinBench(p.period, p.period, p.size));
+    }};
+    reg["outerjoin"] = {{}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new SingleBench(new OuterJoinBench(p.period, p.period, p.size));
+    }};
+    // periods in ticks, independent of --period
+    reg["alterdur"] = {{{"in_period", 3}, {"out_dur", 2}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new SingleBench(new AlterDurBench(p.params.at("in_period"), p.params.at("out_dur"), p.size));
+    }};
+    reg["resample"] = {{{"iperiod", 4}, {"operiod", 5}, {"scale", 1000}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelResampleBench(p.threads, p.params.at("iperiod"), p.params.at("operiod"),
+            p.params.at("scale"), p.size);
+    }};
+    reg["resample_col"] = {{{"iperiod", 4}, {"operiod", 5}, {"scale", 1000}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelResampleBench(p.threads, p.params.at("iperiod"), p.params.at("operiod"),
+            p.params.at("scale"), p.size, true);
+    }};
+    // windows in ticks
+    reg["normalize"] = {{{"window", 10000}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelNormBench(p.threads, p.period, p.params.at("window"), p.size);
+    }};
+    reg["kurtosis"] = {{{"window", 100}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelKurtBench(p.threads, p.period, p.params.at("window"), p.size);
+    }};
+    // imputation over --missing empty slots in runs of `burst`
+    reg["fillmean"] = {{{"window", 10000}, {"burst", 1}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelImputeBench(p.threads, p.period, p.params.at("window"), p.size, missing_ratio,
+            p.params.at("burst"));
+    }};
+    reg["ffill"] = {{{"scale", 1000}, {"burst", 1}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelFFillBench(p.threads, p.period, p.params.at("scale"), p.size, missing_ratio,
+            p.params.at("burst"));
+    }};
+    reg["bfill"] = {{{"horizon", 100}, {"burst", 1}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelBFillBench(p.threads, p.period, p.params.at("horizon") * p.period, p.size, missing_ratio,
+            p.params.at("burst"));
+    }};
+    reg["interp"] = {{{"horizon", 100}, {"burst", 1}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelInterpBench(p.threads, p.period, p.params.at("horizon") * p.period, p.size, missing_ratio,
+            p.params.at("burst"));
+    }};
+    reg["algotrading"] = {{{"w_short", 20}, {"w_long", 50}, {"scale", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelMOCABench(p.threads, p.period, p.params.at("w_short"), p.params.at("w_long"),
+            p.params.at("scale"), p.size);
+    }};
+    reg["rsi"] = {{{"window", 14}, {"scale", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelRSIBench(p.threads, p.period, p.params.at("window"), p.params.at("scale"), p.size);
+    }};
+    reg["keyed_algotrading"] = {{{"symbols", 1000}, {"w_short", 20}, {"w_long", 50}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelKeyedMOCABench(p.threads, p.period, p.params.at("symbols"), p.params.at("w_short"),
+            p.params.at("w_long"), p.size);
+    }};
+    reg["keyed_rsi"] = {{{"symbols", 1000}, {"window", 14}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelKeyedRSIBench(p.threads, p.period, p.params.at("symbols"), p.params.at("window"), p.size);
+    }};
+    reg["largeqty"] = {{{"window", 10}, {"scale", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelLargeQtyBench(p.threads, p.period, p.params.at("window"), p.params.at("scale"), p.size);
+    }};
+    reg["largeqty_col"] = {{{"window", 10}, {"scale", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelLargeQtyBench(p.threads, p.period, p.params.at("window"), p.params.at("scale"), p.size,
+            true);
+    }};
+    reg["pantom"] = {{{"window", 30}, {"scale", 100}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelPeakBench(p.threads, p.period, p.params.at("window"), p.params.at("scale"), p.size);
+    }};
+    for (string name : {"pantom_fused", "pantom_pipe"}) {
+        auto fused = (name == "pantom_fused");
+        reg[name] = {{{"window", 30}, {"scale", 100}}, true, [fused](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelPanTomPipelineBench(p.threads, p.period, p.params.at("window"), p.params.at("scale"),
+                p.size, fused);
+        }};
+    }
+    for (string name : {"normalize_fused", "normalize_pipe"}) {
+        auto fused = (name == "normalize_fused");
+        reg[name] = {{{"window", 10000}}, false, [fused](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelNormPipelineBench(p.threads, p.period, p.params.at("window"), p.size, fused);
+        }};
+    }
+    for (string name : {"query1_fused", "query1_pipe"}) {
+        auto fused = (name == "query1_fused");
+        reg[name] = {{{"w", 1000}, {"win1", 10}, {"win2", 20}}, true, [fused](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelQuery1PipelineBench(p.threads, p.period, p.params.at("w") * p.period,
+                p.params.at("win1"), p.params.at("win2"), p.size, fused);
+        }};
+    }
+    for (string name : {"pantom_stream", "normalize_stream"}) {
+        reg[name] = {{}, true, [name](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelFusionBench(p.threads, name, p.period, p.size);
+        }, [](ParallelBenchmark* bench, BenchResult& res) {
+            res.fused_bytes = static_cast<ParallelFusionBench*>(bench)->eliminated_bytes();
+            res.ring_bytes = static_cast<ParallelFusionBench*>(bench)->ring_bytes();
+        }};
+    }
+    // the input window of the examples spans the whole input
+    vector<function<Benchmark*(const SweepPoint&)>> egs = {
+        [](const SweepPoint& p) -> Benchmark* { return new Eg1Bench(p.period, p.size, p.params.at("win1"), p.params.at("win2"), p.size); },
+        [](const SweepPoint& p) -> Benchmark* { return new Eg2Bench(p.period, p.size, p.params.at("win1"), p.params.at("win2"), p.size); },
+        [](const SweepPoint& p) -> Benchmark* { return new Eg3Bench(p.period, p.size, p.params.at("win1"), p.params.at("win2"), p.size); },
+        [](const SweepPoint& p) -> Benchmark* { return new Eg4Bench(p.period, p.size, p.params.at("win1"), p.params.at("win2"), p.size); },
+        [](const SweepPoint& p) -> Benchmark* { return new Eg5Bench(p.period, p.size, p.params.at("win1"), p.params.at("win2"), p.size); },
+        [](const SweepPoint& p) -> Benchmark* { return new Eg6Bench(p.period, p.size, p.params.at("win1"), p.params.at("win2"), p.size); },
+        [](const SweepPoint& p) -> Benchmark* { return new Eg7Bench(p.period, p.size, p.params.at("win1"), p.params.at("win2"), p.size); },
+    };
+    for (size_t i = 0; i < egs.size(); i++) {
+        auto eg = egs[i];
+        reg["eg" + to_string(i + 1)] = {{{"win1", 10}, {"win2", 20}}, true, [eg](const SweepPoint& p) -> ParallelBenchmark* {
+            return new SingleBench(eg(p));
+        }, nullptr, true};
+    }
+    register_compress<int64_t>(reg, "64");
+    register_compress<int32_t>(reg, "32");
+    register_implicit<float>(reg, "");
+    register_implicit<int8_t>(reg, "8");
+    register_implicit<int64_t>(reg, "64");
+    for (string op : {"select", "where", "sum"}) {
+        for (string type : {"i8", "i16", "i32", "i64", "f32", "f64", "rec2", "rec3", "rec4", "rec5", "rec6", "rec7", "rec8"}) {
+            auto name = "width_" + op + "_" + type;
+            reg[name] = {{{"w", 1000}}, true, [name](const SweepPoint& p) -> ParallelBenchmark* {
+                return new ParallelWidthBench(p.threads, name, p.period, p.params.at("w") * p.period, p.size);
+            }, [](ParallelBenchmark* bench, BenchResult& res) {
+                res.payload_bytes = static_cast<ParallelWidthBench*>(bench)->payload_bytes();
+                res.timeline_bytes = static_cast<ParallelWidthBench*>(bench)->timeline_bytes();
+            }};
+        }
+    }
+    for (string type : {"i8", "i16", "i32", "i64", "f32", "f64"}) {
+        auto name = "compactwhere_" + type;
+        reg[name] = {{}, false, [name](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelCompactWhereBench(p.threads, name, p.period, p.size);
+        }};
+    }
+    for (string query : {"aggregate", "sum64", "sum8", "max", "min", "avgonepass", "var64onepass"}) {
+        auto name = "vec" + query;
+        reg[name] = {{{"w", 1000}}, true, [name](const SweepPoint& p) -> ParallelBenchmark* {
+            return new ParallelTumbleBench(p.threads, name, p.period, p.size, p.params.at("w") * p.period);
+        }};
+    }
+    reg["reorder"] = {{}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelReorderBench(p.threads, p.period, p.size);
+    }};
+
+    // open-loop producers at `rate` events per second
+    auto open_loop = [](ParallelBenchmark*, BenchResult& res) { res.open_loop = true; };
+    reg["openloop_select"] = {{{"rate", 1000000}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelOpenLoopBench(p.threads, [](_sym in) {
+            return _Select(in, [](_sym e) { return e + _f32(3); });
+        }, p.period, p.period, 0, p.size, p.params.at("rate"));
+    }, open_loop};
+    reg["openloop_where"] = {{{"rate", 1000000}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        return new ParallelOpenLoopBench(p.threads, [](_sym in) {
+            return _Where(in, [](_sym e) { return _gt(e, _f32(0)); });
+        }, p.period, p.period, 0, p.size, p.params.at("rate"));
+    }, open_loop};
+    reg["openloop_aggregate"] = {{{"w", 1000}, {"rate", 1000000}}, true, [](const SweepPoint& p) -> ParallelBenchmark* {
+        auto w = p.params.at("w") * p.period;
+        return new ParallelOpenLoopBench(p.threads, [w](_sym in) {
+            return _WindowSum(in, w);
+        }, p.period, w, w, p.size, p.params.at("rate"));
+    }, open_loop};
+    reg["openloop_normalize"] = {{{"window", 10000}, {"rate", 1000000}}, false, [](const SweepPoint& p) -> ParallelBenchmark* {
+        auto window = p.params.at("window");
+        return new ParallelOpenLoopBench(p.threads, [window](_sym in) {
+            return _Norm(in, window);
+        }, p.period, window, window, p.size, p.params.at("rate"));
+    }, open_loop};
+    return reg;
+}
+
+string format_params(const SweepPoint& point, const string& sep)
+{
+    string res;
+    for (auto& param : point.params) {
+        res += (res.empty() ? "" : sep) + param.first + "=" + to_string(param.second);
+    }
+    return res;
+}
+
+// Runs `entry` at `point` and collects what it reports. Runs of the same
+// generated code in one process share the compiled query.
+BenchResult run_bench(const BenchEntry& entry, const SweepPoint& point)
+{
+    unique_ptr<ParallelBenchmark> bench(entry.make(point));
+    bench->code_key = point.testcase + ":" + format_params(point, ",")
+        + (entry.period_in_code ? ":period=" + to_string(point.period) : "")
+        + (entry.size_in_code ? ":size=" + to_string(point.size) : "");
+
+    BenchResult res;
+    res.time_us = bench->run();
+    res.compile_us = bench->compile_us;
+    res.reused = bench->reused;
+    res.out_count = bench->sink_count();
+    res.out_checksum = bench->sink_checksum();
+    res.verdict = bench->verdict();
+    res.latency = bench->latency();
+    res.batch_events = bench->batch_events();
+    res.tier = bench->tier_stats();
+    res.profile = bench->op_profile();
+    res.in_bytes = bench->input_bytes();
+    if (entry.stats) {
+        entry.stats(bench.get(), res);
+    }
+    return res;
+}
+
+// Result of one point of a sweep
+struct SweepResult {
+    SweepPoint point;
+    int64_t compile_us;
+    bool reused;
+    int64_t time_us;
+    Verdict verdict;
+};
+
+class Sweep {
+public:
+    // `spec` is a file name, or the spec itself when it contains '='
+    explicit Sweep(const string& spec)
+    {
+        string text = spec;
+        if (spec.find('=') == string::npos) {
+            ifstream f(spec);
+            if (!f) {
+                throw runtime_error("Cannot open sweep spec " + spec);
+            }
+            stringstream ss;
+            ss << f.rdbuf();
+            text = ss.str();
+        }
+        for (auto& c : text) {
+            c = (c == ';') ? '\n' : c;
+        }
+
+        stringstream lines(text);
+        string line;
+        while (getline(lines, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            auto eq = line.find('=');
+            if (eq == string::npos) {
+                throw runtime_error("Invalid sweep line " + line);
+            }
+            vector<string> values;
+            stringstream vs(line.substr(eq + 1));
+            string v;
+            while (getline(vs, v, ',')) {
+                values.push_back(v);
+            }
+            dims[line.substr(0, eq)] = values;
+        }
+        if (!dims.count("testcase")) {
+            throw runtime_error("Sweep spec without testcase");
+        }
+    }
+
+    vector<SweepResult> run()
+    {
+        auto registry = bench_registry();
+        check_keys(registry);
+
+        vector<SweepResult> results;
+        for (auto& testcase : dims["testcase"]) {
+            auto& entry = registry.at(testcase);
+
+            // the dimensions of this testcase, each with its values
+            vector<pair<string, vector<int64_t>>> axes;
+            for (string key : {"period", "size", "threads"}) {
+                axes.push_back({key, values(key, (key == "size") ? 10000000 : 1)});
+            }
+            for (auto& param : entry.params) {
+                axes.push_back({param.first, values(param.first, param.second)});
+            }
+
+            vector<size_t> pos(axes.size(), 0);
+            while (true) {
+                SweepPoint point{testcase, axes[0].second[pos[0]], axes[1].second[pos[1]],
+                    static_cast<int>(axes[2].second[pos[2]]), {}};
+                for (size_t i = 3; i < axes.size(); i++) {
+                    point.params[axes[i].first] = axes[i].second[pos[i]];
+                }
+                results.push_back(run_point(entry, point));
+
+                // next point, the last dimension varies fastest
+                auto i = axes.size();
+                while (i > 0 && ++pos[i - 1] == axes[i - 1].second.size()) {
+                    pos[--i] = 0;
+                }
+                if (i == 0) {
+                    break;
+                }
+            }
+        }
+        return results;
+    }
+
+    static void write_csv(ostream& os, const vector<SweepResult>& results)
+    {
+        os << "testcase,period,size,threads,params,compile_ms,reused,time_ms,throughput_mps,verify" << endl;
+        for (auto& r : results) {
+            auto& p = r.point;
+            os << p.testcase << "," << p.period << "," << p.size << "," << p.threads << ","
+                << format_params(p, " ") << "," << r.compile_us / 1e3 << "," << r.reused << ","
+                << r.time_us / 1e3 << "," << (double) (p.size * p.threads) / r.time_us << ","
+                << verdict_str(r.verdict) << endl;
+        }
+    }
+
+    static void write_json(ostream& os, const vector<SweepResult>& results)
+    {
+        os << "[" << endl;
+        for (size_t i = 0; i < results.size(); i++) {
+            auto& r = results[i];
+            auto& p = r.point;
+            os << "  {\"testcase\": \"" << p.testcase << "\", \"period\": " << p.period
+                << ", \"size\": " << p.size << ", \"threads\": " << p.threads << ", \"params\": {";
+            bool first = true;
+            for (auto& param : p.params) {
+                os << (first ? "" : ", ") << "\"" << param.first << "\": " << param.second;
+                first = false;
+            }
+            os << "}, \"compile_ms\": " << r.compile_us / 1e3 << ", \"reused\": " << (r.reused ? "true" : "false")
+                << ", \"time_ms\": " << r.time_us / 1e3
+                << ", \"throughput_mps\": " << (double) (p.size * p.threads) / r.time_us
+                << ", \"verify\": \"" << verdict_str(r.verdict) << "\"}"
+                << ((i + 1 < results.size()) ? "," : "") << endl;
+        }
+        os << "]" << endl;
+    }
+
+private:
+    static string verdict_str(const Verdict& v)
+    {
+        return !v.checked ? "UNCHECKED" : (v.mismatches == 0 ? "OK" : "FAIL");
+    }
+
+    void check_keys(const map<string, BenchEntry>& registry)
+    {
+        for (auto& testcase : dims["testcase"]) {
+            if (!registry.count(testcase)) {
+                throw runtime_error("Testcase " + testcase + " is not registered");
+            }
+        }
+        for (auto& dim : dims) {
+            bool known = (dim.first == "testcase" || dim.first == "period" || dim.first == "size"
+                || dim.first == "threads");
+            for (auto& entry : registry) {
+                for (auto& param : entry.second.params) {
+                    known |= (param.first == dim.first);
+                }
+            }
+            if (!known) {
+                throw runtime_error("Unknown sweep parameter " + dim.first);
+            }
+        }
+    }
+
+    vector<int64_t> values(const string& key, int64_t def)
+    {
+        if (!dims.count(key)) {
+            return {def};
+        }
+        vector<int64_t> res;
+        for (auto& v : dims[key]) {
+            res.push_back(stol(v));
+        }
+        return res;
+    }
+
+    SweepResult run_point(const BenchEntry& entry, const SweepPoint& point)
+    {
+        auto res = run_bench(entry, point);
+        return SweepResult{point, res.compile_us, res.reused, res.time_us, res.verdict};
+    }
+
+    map<string, vector<string>> dims;
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_REGISTRY_H_
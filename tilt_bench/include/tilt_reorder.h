@@ -0,0 +1,199 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_REORDER_H_
+#define TILT_BENCH_INCLUDE_TILT_REORDER_H_
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_bench.h"
+#include "tilt_arrival.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Watermark-driven reordering ahead of a region.
+ *
+ * commit_data only appends, so events arriving out of order within a delay
+ * of `bound` ticks are staged in a ring of time buckets of `width` ticks,
+ * keyed by end time. The watermark trails the latest end time seen by
+ * bound + 1 ticks, so no event within the bound can fall behind it. Every
+ * bucket that ends at or before the watermark is sorted and committed to the
+ * region as one chunk; the region is then complete up to the watermark.
+ * Events older than the watermark exceed the bound and are dropped. Every
+ * bucket is reserved for `capacity` events up front. */
+template<typename T>
+class ReorderBuffer {
+public:
+    typedef typename DisorderedArrivals<T>::Event Event;
+
+    ReorderBuffer(region_t* reg, dur_t bound, dur_t width, int64_t capacity) :
+        reg(reg), bound(bound), width(width),
+        buckets(get_buf_size((bound + 1) / width + 3)), mask(buckets.size() - 1)
+    {
+        for (auto& events : buckets) {
+            events.reserve(capacity);
+        }
+    }
+
+    // bucket of the events ending at `t`
+    static int64_t bucket(ts_t t, dur_t width) { return (t - 1) / width; }
+
+    void insert(const Event& e)
+    {
+        // flushing first keeps the pending buckets within one turn of the ring
+        if (e.t > latest) {
+            latest = e.t;
+            advance(latest - bound - 1);
+        }
+        if (e.t <= flushed) {
+            late++;
+            return;
+        }
+        buckets[bucket(e.t) & mask].push_back(e);
+    }
+
+    // commits everything left, e.g. at the end of the stream
+    void finish()
+    {
+        advance(latest);
+    }
+
+    // end of the committed prefix of the stream
+    ts_t watermark() const { return flushed; }
+
+    int64_t late = 0;
+    int64_t watermarks = 0;
+
+private:
+    int64_t bucket(ts_t t) const { return bucket(t, width); }
+
+    void advance(ts_t wm)
+    {
+        auto b = bucket(flushed + 1);
+        auto last = (wm >= latest) ? bucket(latest) : wm / width - 1;
+        if (last < b) {
+            return;
+        }
+        // pending events span at most one turn of the ring, so a jump in time
+        // skips the empty buckets beyond it
+        for (auto stop = min(last, b + mask); b <= stop; b++) {
+            auto& events = buckets[b & mask];
+            sort(events.begin(), events.end(), [](const Event& l, const Event& r) { return l.t < r.t; });
+            for (auto& e : events) {
+                if (get_end_time(reg) < e.t - e.d) {
+                    commit_null(reg, e.t - e.d);
+                }
+                commit_data(reg, e.t);
+                *reinterpret_cast<T*>(fetch(reg, e.t, get_end_idx(reg), sizeof(T))) = e.payload;
+            }
+            events.clear();
+        }
+        flushed = max(flushed, min(wm, (last + 1) * width));
+        watermarks++;
+    }
+
+    region_t* reg;
+    dur_t bound;
+    dur_t width;
+    vector<vector<Event>> buckets;
+    int64_t mask;
+
+    ts_t latest = 0;
+    ts_t flushed = 0;
+};
+
+// Ingests a stream delivered out of order within --disorder ticks through a
+// ReorderBuffer. Generating the arrival order and setting up the buffer is
+// not timed, so the throughput is the cost of reordering and committing alone.
+class ReorderBench : public Benchmark {
+public:
+    ReorderBench(dur_t period, int64_t size) :
+        period(period), size(size)
+    {}
+
+    bool native() override { return true; }
+
+    // no TiLT query to compile, execute() runs the ingestion
+    intptr_t compile() override { return 0; }
+
+private:
+    typedef DisorderedArrivals<float>::Event Event;
+
+    Op query() final
+    {
+        throw runtime_error("Reorder benchmarks have no TiLT query");
+    }
+
+    void init() final
+    {
+        DisorderedArrivals<float> arrivals(arrival_spec, period, size,
+            [](int64_t k) { return static_cast<float>(k % 1000); });
+        events.clear();
+        events.reserve(size);
+        Event e;
+        while (arrivals.next(e)) {
+            events.push_back(e);
+        }
+        out_reg = create_in_reg<float>(size);
+
+        // about 64 buckets span the bound. A bucket holds the events of one
+        // span of end times at a time, so reserving the most events of a span
+        // keeps execute() from growing it.
+        auto width = max<dur_t>(period, arrival_spec.disorder / 64 + 1);
+        vector<int64_t> counts(ReorderBuffer<float>::bucket(period * size, width) + 1, 0);
+        int64_t capacity = 0;
+        for (auto& e : events) {
+            capacity = max(capacity, ++counts[ReorderBuffer<float>::bucket(e.t, width)]);
+        }
+        buffer = make_unique<ReorderBuffer<float>>(&out_reg, arrival_spec.disorder, width, capacity);
+    }
+
+    void execute(intptr_t) final
+    {
+        for (auto& e : events) {
+            buffer->insert(e);
+        }
+        buffer->finish();
+        late = buffer->late;
+    }
+
+    Verdict verify() final
+    {
+        vector<RefEvent<float>> ref;
+        for (auto& e : events) {
+            ref.push_back(RefEvent<float>{e.t, e.payload});
+        }
+        sort(ref.begin(), ref.end(), [](const RefEvent<float>& l, const RefEvent<float>& r) { return l.t < r.t; });
+        auto verdict = ref_compare(&out_reg, ref);
+        verdict.mismatches += late;
+        return verdict;
+    }
+
+    void release() final
+    {
+        release_reg(&out_reg);
+        events.clear();
+        buffer.reset();
+    }
+
+    dur_t period;
+    int64_t size;
+    vector<Event> events;
+    region_t out_reg;
+    unique_ptr<ReorderBuffer<float>> buffer;
+    int64_t late = 0;
+};
+
+class ParallelReorderBench : public ParallelBenchmark {
+public:
+    ParallelReorderBench(int threads, dur_t period, int64_t size)
+    {
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(new ReorderBench(period, size));
+        }
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_REORDER_H_
@@ -6,6 +6,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_arena.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -86,55 +87,197 @@ Op _Resample(_sym in, int64_t iperiod, int64_t operiod, int64_t scale)
     return resample_op;
 }
 
+// End times of the _Pair events, the positions the columns below align to
+Op _PairTime(_sym in, int64_t iperiod)
+{
+    auto ev = in[_pt(0)];
+    auto ev_sym = _sym("ev", ev);
+    auto sv = in[_pt(-iperiod)];
+    auto sv_sym = _sym("sv", sv);
+    auto beat = _beat(_iter(0, iperiod));
+    auto et = _cast(types::FLOAT32, beat[_pt(0)]);
+    auto et_sym = _sym("et", et);
+    return _op(
+        _iter(0, iperiod),
+        Params{in, beat},
+        SymTable{
+            {sv_sym, sv},
+            {ev_sym, ev},
+            {et_sym, et},
+        },
+        _exists(sv_sym) && _exists(ev_sym),
+        et_sym);
+}
+
+// One value column of the _Pair struct, the input `offset` back at every
+// position of `et`: -iperiod for sv, 0 for ev
+Op _PairColumn(_sym in, _sym et, int64_t iperiod, int64_t offset)
+{
+    auto e_et = et[_pt(0)];
+    auto e_et_sym = _sym("e_et", e_et);
+    auto v = in[_pt(offset)];
+    auto v_sym = _sym("v", v);
+    return _op(
+        _iter(0, iperiod),
+        Params{in, et},
+        SymTable{
+            {e_et_sym, e_et},
+            {v_sym, v},
+        },
+        _exists(e_et_sym),
+        v_sym);
+}
+
+Op _InterpolateColumnar(_sym et, _sym sv, _sym ev, int64_t iperiod, int64_t operiod)
+{
+    auto e_et = et[_pt(0)];
+    auto e_et_sym = _sym("e_et", e_et);
+    auto e_sv = sv[_pt(0)];
+    auto e_sv_sym = _sym("e_sv", e_sv);
+    auto e_ev = ev[_pt(0)];
+    auto e_ev_sym = _sym("e_ev", e_ev);
+    auto e_st = e_et_sym - _f32(iperiod);
+    auto e_st_sym = _sym("e_st", e_st);
+    auto beat = _beat(_iter(0, operiod));
+    auto t = _cast(types::FLOAT32, beat[_pt(0)]);
+    auto t_sym = _sym("t", t);
+    auto res = (((e_ev_sym - e_sv_sym) * (t_sym - e_st_sym)) / (e_et_sym - e_st_sym)) + e_sv_sym;
+    auto res_sym = _sym("res", res);
+    return _op(
+        _iter(0, operiod),
+        Params{et, sv, ev, beat},
+        SymTable{
+            {e_et_sym, e_et},
+            {e_sv_sym, e_sv},
+            {e_ev_sym, e_ev},
+            {e_st_sym, e_st},
+            {t_sym, t},
+            {res_sym, res},
+        },
+        _exists(e_et_sym),
+        res_sym);
+}
+
+// _Resample with the paired intermediate stored columnar. The pair positions
+// are found once; the sv and ev columns only read the input at them, and st
+// is et one input period back. The columns are written into the regions of
+// `et_col`, `sv_col` and `ev_col`, which share one timeline.
+Op _ResampleColumnar(_sym in, _sym et_col, _sym sv_col, _sym ev_col, int64_t iperiod, int64_t operiod, int64_t scale)
+{
+    auto win_size = scale * lcm(iperiod, operiod);
+    auto win = in[_win(-win_size, 0)];
+    auto win_sym = _sym("win", win);
+    auto et = _PairTime(win_sym, iperiod);
+    auto et_sym = _sym("pair_et", et);
+    auto sv = _PairColumn(win_sym, et_sym, iperiod, -iperiod);
+    auto sv_sym = _sym("pair_sv", sv);
+    auto ev = _PairColumn(win_sym, et_sym, iperiod, 0);
+    auto ev_sym = _sym("pair_ev", ev);
+    auto inter = _InterpolateColumnar(et_sym, sv_sym, ev_sym, iperiod, operiod);
+    auto inter_sym = _sym("inter", inter);
+
+    return _op(
+        _iter(0, win_size),
+        Params{in, et_col, sv_col, ev_col},
+        SymTable{
+            {win_sym, win},
+            {et_sym, et},
+            {sv_sym, sv},
+            {ev_sym, ev},
+            {inter_sym, inter},
+        },
+        _true(),
+        inter_sym,
+        Aux{
+            {et_sym, et_col},
+            {sv_sym, sv_col},
+            {ev_sym, ev_col}
+        });
+}
+
 class ResampleBench : public Benchmark {
 public:
-    ResampleBench(dur_t iperiod, int64_t operiod, int64_t scale, int64_t size) :
-        iperiod(iperiod), operiod(operiod), scale(scale), size(size)
+    ResampleBench(dur_t iperiod, int64_t operiod, int64_t scale, int64_t size, bool columnar = false) :
+        iperiod(iperiod), operiod(operiod), scale(scale), size(size), columnar(columnar)
     {}
 
 private:
     Op query() final
     {
         auto in_sym = _sym("in", tilt::Type(types::FLOAT32, _iter(0, -1)));
+        if (columnar) {
+            auto et_sym = _sym("et_col", tilt::Type(types::FLOAT32, _iter(0, -1)));
+            auto sv_sym = _sym("sv_col", tilt::Type(types::FLOAT32, _iter(0, -1)));
+            auto ev_sym = _sym("ev_col", tilt::Type(types::FLOAT32, _iter(0, -1)));
+            return _ResampleColumnar(in_sym, et_sym, sv_sym, ev_sym, iperiod, operiod, scale);
+        }
         return _Resample(in_sym, iperiod, operiod, scale);
     }
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
         float osize = ((float)iperiod / (float)operiod) * size;
         out_reg = create_reg<float>(ceil(osize));
 
         SynthData<float> dataset(iperiod, size);
         dataset.fill(&in_reg);
+
+        if (columnar) {
+            // one pair per input period of a window; sv and ev are payload
+            // columns over the timeline of et
+            auto pairs = scale * lcm(iperiod, operiod) / iperiod;
+            et_col = RegionArena::Get(part)->state<float>(pairs, query(), 1);
+            sv_col = map_reg<float, float>(et_col, [](float) { return 0.0f; });
+            ev_col = map_reg<float, float>(et_col, [](float) { return 0.0f; });
+        }
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, iperiod * size, &out_reg, &in_reg);
+        if (columnar) {
+            auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*, region_t*, region_t*)) addr;
+            query(0, iperiod * size, &out_reg, &in_reg, et_col, &sv_col, &ev_col);
+        } else {
+            auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
+            query(0, iperiod * size, &out_reg, &in_reg);
+        }
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_resample(&in_reg, iperiod, operiod, iperiod * size));
     }
 
     void release() final
     {
         release_reg(&in_reg);
         release_reg(&out_reg);
+        if (columnar) {
+            release_col(&sv_col);
+            release_col(&ev_col);
+            RegionArena::Get(part)->reset();
+        }
     }
 
     dur_t iperiod;
     dur_t operiod;
     int64_t size;
     int64_t scale;
+    bool columnar;
     region_t in_reg;
+    region_t* et_col;
+    region_t sv_col;
+    region_t ev_col;
     region_t out_reg;
 };
 
 class ParallelResampleBench : public ParallelBenchmark {
 public:
-    ParallelResampleBench(int threads, dur_t iperiod, int64_t operiod, int64_t scale, int64_t size)
+    ParallelResampleBench(int threads, dur_t iperiod, int64_t operiod, int64_t scale, int64_t size, bool columnar = false)
     {
         for (int i = 0; i < threads; i++) {
-            benchs.push_back(new ResampleBench(iperiod, operiod, scale, size));
+            benchs.push_back(new ResampleBench(iperiod, operiod, scale, size, columnar));
         }
     }
 };
@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_arena.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -138,9 +139,9 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
-        state_reg = create_reg<RSIState>(scale);
-        out_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
+        state_reg = RegionArena::Get(part)->state<RSIState>(scale, query(), 1);
+        out_reg = create_out_reg<float>(size, size);
 
         SynthData<float> dataset(period, size);
         dataset.fill(&in_reg);
@@ -148,14 +149,18 @@ private:
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg, &state_reg);
+        run_query(addr, period * size, size, period * scale, &out_reg, &in_reg, state_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_rsi(&in_reg, period, window));
     }
 
     void release() final
     {
         release_reg(&in_reg);
-        release_reg(&state_reg);
+        RegionArena::Get(part)->reset();
         release_reg(&out_reg);
     }
 
@@ -164,7 +169,7 @@ private:
     int64_t scale;
     int64_t size;
     region_t in_reg;
-    region_t state_reg;
+    region_t* state_reg;
     region_t out_reg;
 };
 
@@ -28,6 +28,8 @@ public:
         period(period), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -37,17 +39,22 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
-        out_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
+        out_reg = create_out_reg<float>(size, size);
 
         SynthData<float> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<float>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, 1, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_select<float, float>(&in_reg, [](float v) -> float { return v + 3; }));
     }
 
     void release() final
@@ -85,6 +92,8 @@ public:
         period(period), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -94,17 +103,22 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
-        out_reg = create_reg<int64_t>(size);
+        in_reg = create_in_reg<int64_t>(size);
+        out_reg = create_out_reg<int64_t>(size, size);
 
         SynthData<int64_t> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<int64_t>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, 1, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_select<int64_t, int64_t>(&in_reg, [](int64_t v) -> int64_t { return v + 3; }));
     }
 
     void release() final
@@ -140,6 +154,8 @@ public:
         period(period), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -149,17 +165,22 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int8_t>(size);
-        out_reg = create_reg<int8_t>(size);
+        in_reg = create_in_reg<int8_t>(size);
+        out_reg = create_out_reg<int8_t>(size, size);
 
         SynthData<int8_t> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<int8_t>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, 1, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_select<int8_t, int8_t>(&in_reg, [](int8_t v) -> int8_t { return v + 3; }));
     }
 
     void release() final
@@ -0,0 +1,112 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_SINK_H_
+#define TILT_BENCH_INCLUDE_TILT_SINK_H_
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "tilt/builder/tilder.h"
+
+using namespace std;
+
+// Where query output goes. Parsed from the main.cpp flags
+//   --sink=full | count | checksum | file:<path>
+//   --chunk=<input events per slice>
+//   --sink_thread=<0|1>
+// `full` keeps the whole output region as before. The other modes run the
+// query in time slices into a bounded output ring that the sink drains after
+// every slice, inline or on a consumer thread.
+enum class SinkMode { FULL, COUNT, CHECKSUM, FILE };
+
+struct SinkSpec {
+    SinkMode mode = SinkMode::FULL;
+    string path;
+    int64_t chunk = 1 << 16;
+    bool thread = false;
+
+    void set_mode(const string& str)
+    {
+        if (str == "full") {
+            mode = SinkMode::FULL;
+        } else if (str == "count") {
+            mode = SinkMode::COUNT;
+        } else if (str == "checksum") {
+            mode = SinkMode::CHECKSUM;
+        } else if (str.rfind("file:", 0) == 0 && str.size() > 5) {
+            mode = SinkMode::FILE;
+            path = str.substr(5);
+        } else {
+            throw runtime_error("Invalid sink " + str);
+        }
+    }
+};
+
+// Output mode used by the benchmarks, set once from main.cpp
+inline SinkSpec sink_spec;
+
+const uint64_t kFNVBasis = 14695981039346656037ull;
+
+// FNV-1a over `len` bytes, continuing from hash `h`
+inline uint64_t fnv1a(uint64_t h, const void* buf, int64_t len)
+{
+    auto bytes = static_cast<const uint8_t*>(buf);
+    for (int64_t i = 0; i < len; i++) {
+        h = (h ^ bytes[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+// Consumes the data entries of an output region of `width` byte payloads.
+// Nulls are skipped; the checksum is order dependent and covers the interval
+// and the payload of every entry.
+class Sink {
+public:
+    void open(int64_t width, const string& name)
+    {
+        this->width = width;
+        if (sink_spec.mode == SinkMode::FILE) {
+            file.open(sink_spec.path + "." + name, ios::binary);
+            if (!file) {
+                throw runtime_error("Cannot open sink file " + sink_spec.path + "." + name);
+            }
+        }
+    }
+
+    // consumes the entries (from, to] of `reg`
+    void consume(region_t* reg, idx_t from, idx_t to)
+    {
+        for (auto i = from + 1; i <= to; i++) {
+            auto iv = reg->tl[i & reg->mask];
+            if (iv.d == 0) {
+                continue;
+            }
+            auto ptr = reg->data + (i & reg->mask) * width;
+            count++;
+            if (sink_spec.mode == SinkMode::CHECKSUM) {
+                checksum = fnv1a(checksum, &iv.t, sizeof(ts_t));
+                checksum = fnv1a(checksum, &iv.d, sizeof(dur_t));
+                checksum = fnv1a(checksum, ptr, width);
+            } else if (sink_spec.mode == SinkMode::FILE) {
+                file.write(reinterpret_cast<char*>(&iv), sizeof(ival_t));
+                file.write(ptr, width);
+            }
+        }
+    }
+
+    void close()
+    {
+        if (file.is_open()) {
+            file.close();
+        }
+    }
+
+    int64_t count = 0;
+    uint64_t checksum = kFNVBasis;
+
+private:
+    int64_t width = 0;
+    ofstream file;
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_SINK_H_
@@ -20,12 +20,12 @@ private:
     Op query() final
     {
         auto in_sym = _sym("in", tilt::Type(types::INT64, _iter(0, -1)));
-        return _WindowSum(in_sym, 100, 50);
+        return _WindowSum64(in_sym, 100, 50);
     }
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
+        in_reg = create_in_reg<int64_t>(size);
         float osize = (float)size / 50;
         out_reg = create_reg<int64_t>(ceil(osize));
 
@@ -39,6 +39,11 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_sliding_sum<int64_t>(&in_reg, 100, 50, period * size));
+    }
+
     void release() final
     {
 #ifdef _PRINT_REGION_
@@ -107,7 +112,7 @@ Op _SlidingSums(_sym in, dur_t period, int64_t size)
 {
     auto win = in[_win(-(period * size), 0)];
     auto win_sym = _sym("win", win);
-    auto partial_sums = _WindowSum(win_sym, 50);
+    auto partial_sums = _WindowSum64(win_sym, 50);
     auto partial_sums_sym = _sym("partial_sums", partial_sums);
 
     auto res = _IncrementSums(partial_sums_sym);
@@ -142,7 +147,7 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
+        in_reg = create_in_reg<int64_t>(size);
         float osize = (float)size / 50;
         out_reg = create_reg<int64_t>(ceil(osize));
 
@@ -156,6 +161,11 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_sliding_sum<int64_t>(&in_reg, 100, 50, period * size));
+    }
+
     void release() final
     {
 #ifdef _PRINT_REGION_
@@ -51,7 +51,7 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
+        in_reg = create_in_reg<int64_t>(size);
         float osize = (float)size / (float)w;
         out_reg = create_reg<int64_t>(ceil(osize));
 
@@ -65,6 +65,13 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        auto ref = ref_window<int64_t, int64_t>(&in_reg, w, period * size, 0,
+            [](int64_t s, int64_t v) { return (v > 0) ? s + v : s; });
+        return ref_compare(&out_reg, ref);
+    }
+
     void release() final
     {
 #ifdef _PRINT_REGION_
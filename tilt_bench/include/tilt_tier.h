@@ -0,0 +1,78 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_TIER_H_
+#define TILT_BENCH_INCLUDE_TILT_TIER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace std;
+
+/* Tiered execution.
+ *
+ * A query normally starts only once LLVM has compiled it. In tiered mode a
+ * benchmark starts right away on tier 0 (Benchmark::tier0), the interpreter
+ * of tilt_interp.h or a native baseline of its query, while the query
+ * compiles on a background thread, and every benchmark switches to the
+ * compiled code at the first slice boundary after it is ready. The query then
+ * runs in slices even with a full sink, and every slice is recorded, which
+ * gives the time to the first result and the throughput over time. Mode jit records the same way but compiles
+ * first, as the default mode does. */
+
+enum class TierMode {
+    OFF,
+    JIT,
+    TIERED,
+};
+
+// Set once from the main.cpp flag --tiered=<off|jit|tiered>
+inline TierMode tier_mode = TierMode::OFF;
+
+inline void set_tier_mode(const string& mode)
+{
+    if (mode == "off") {
+        tier_mode = TierMode::OFF;
+    } else if (mode == "jit") {
+        tier_mode = TierMode::JIT;
+    } else if (mode == "tiered") {
+        tier_mode = TierMode::TIERED;
+    } else {
+        throw runtime_error("Invalid tiered mode " + mode);
+    }
+}
+
+// Progress of a query after one slice: microseconds since it started, input
+// events done and whether the slice ran compiled code
+struct TierSample {
+    int64_t us;
+    int64_t events;
+    bool compiled;
+};
+
+// Startup of one run: time from the start of the query to its first output
+// and to its first slice of compiled code, both including the wait for the
+// compiler, and the slices of its first partition. Times are -1 if there was
+// no such slice.
+struct TierStats {
+    int64_t first_result_us = -1;
+    int64_t switch_us = -1;
+    int64_t compile_us = 0;
+    vector<TierSample> samples;
+};
+
+// Writes `samples` as csv, one line per slice with the throughput of the slice
+inline void write_tier_samples(ostream& os, const vector<TierSample>& samples)
+{
+    os << "time_ms,events,tier,throughput_mps" << endl;
+    int64_t prev_us = 0, prev_events = 0;
+    for (auto& s : samples) {
+        auto us = max<int64_t>(s.us - prev_us, 1);
+        os << s.us / 1e3 << "," << s.events << "," << (s.compiled ? "jit" : "tier0") << ","
+            << (double) (s.events - prev_events) / us << endl;
+        prev_us = s.us;
+        prev_events = s.events;
+    }
+}
+
+#endif  // TILT_BENCH_INCLUDE_TILT_TIER_H_
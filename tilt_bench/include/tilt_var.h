@@ -4,6 +4,7 @@
 #include "tilt/builder/tilder.h"
 #include "tilt_base.h"
 #include "tilt_bench.h"
+#include "tilt_reduce.h"
 
 using namespace tilt;
 using namespace tilt::tilder;
@@ -25,7 +26,7 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
+        in_reg = create_in_reg<int64_t>(size);
         float osize = (float)size / (float)window;
         out_reg = create_reg<float>(ceil(osize));
 
@@ -39,6 +40,11 @@ private:
         query(0, period * size, &out_reg, &in_reg);
     }
 
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, Var64Red::ref(&in_reg, window, period * size));
+    }
+
     void release() final
     {
 #ifdef _PRINT_REGION_
@@ -16,6 +16,8 @@ public:
         period(period), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -25,17 +27,22 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<float>(size);
-        out_reg = create_reg<float>(size);
+        in_reg = create_in_reg<float>(size);
+        out_reg = create_out_reg<float>(size, size);
 
         SynthData<float> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<float>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, 1, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_where<float>(&in_reg, [](float v) { return v > 0; }));
     }
 
     void release() final
@@ -73,6 +80,8 @@ public:
         period(period), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -82,17 +91,22 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int64_t>(size);
-        out_reg = create_reg<int64_t>(size);
+        in_reg = create_in_reg<int64_t>(size);
+        out_reg = create_out_reg<int64_t>(size, size);
 
         SynthData<int64_t> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<int64_t>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, 1, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_where<int64_t>(&in_reg, [](int64_t v) { return v > 0; }));
     }
 
     void release() final
@@ -128,6 +142,8 @@ public:
         period(period), size(size)
     {}
 
+    bool partitionable() override { return true; }
+
 private:
     Op query() final
     {
@@ -137,17 +153,22 @@ private:
 
     void init() final
     {
-        in_reg = create_reg<int8_t>(size);
-        out_reg = create_reg<int8_t>(size);
+        in_reg = create_in_reg<int8_t>(size);
+        out_reg = create_out_reg<int8_t>(size, size);
 
         SynthData<int8_t> dataset(period, size);
         dataset.fill(&in_reg);
+        input_bytes = reg_bytes<int8_t>(&in_reg);
     }
 
     void execute(intptr_t addr) final
     {
-        auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        run_query(addr, period * size, size, 1, &out_reg, &in_reg);
+    }
+
+    Verdict verify() final
+    {
+        return ref_compare(&out_reg, ref_where<int8_t>(&in_reg, [](int8_t v) { return v > 0; }));
     }
 
     void release() final
@@ -0,0 +1,320 @@
+#ifndef TILT_BENCH_INCLUDE_TILT_WIDTH_H_
+#define TILT_BENCH_INCLUDE_TILT_WIDTH_H_
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <stdexcept>
+
+#include "tilt/builder/tilder.h"
+#include "tilt_base.h"
+#include "tilt_bench.h"
+#include "tilt_select.h"
+#include "tilt_compress.h"
+
+using namespace tilt;
+using namespace tilt::tilder;
+
+/* Payload width scaling.
+ *
+ * One templated select / where / tumbling sum benchmark over the payload
+ * type: int8 to int64, float, double and records of 2 to 8 float fields.
+ * Every event also carries a 16 byte ival_t in the timeline, so besides
+ * events/s the suite reports the bytes of payload and of timeline the query
+ * reads and writes per second. Comparing the two across widths tells
+ * whether a query is bound by memory or by the work per event. */
+
+// Events above this value pass the where queries of the suite, set once
+// from the main.cpp flag --threshold=<value> to vary their selectivity
+inline double where_threshold = 0;
+
+// Record of N float fields
+template<int N>
+struct Record {
+    float f[N];
+};
+
+template<size_t I> using RecordField = float;
+
+template<int N> struct TiltType<Record<N>> {
+    static DataType type() { return fields(make_index_sequence<N>()); }
+
+    template<size_t... I>
+    static DataType fields(index_sequence<I...>) { return types::STRUCT<RecordField<I>...>(); }
+};
+
+// The queries of the suite and their references for one payload type. A
+// record is selected and summed field by field and filtered on its first field.
+template<typename T>
+struct WidthOps {
+    static Expr select(Expr e) { return e + TiltType<T>::val(3); }
+    static Expr filter(Expr e) { return _gt(e, TiltType<T>::val(static_cast<T>(where_threshold))); }
+    static Expr zero() { return TiltType<T>::val(0); }
+    static Expr add(Expr s, Expr d) { return _add(s, d); }
+
+    static T ref_select(T v) { return v + 3; }
+    static bool ref_filter(T v) { return v > static_cast<T>(where_threshold); }
+    static T ref_zero() { return 0; }
+    static T ref_add(T s, T v) { return s + v; }
+
+    static void fill(region_t* reg, dur_t period, int64_t size)
+    {
+        SynthData<T> dataset(period, size);
+        dataset.fill(reg);
+    }
+};
+
+template<int N>
+struct WidthOps<Record<N>> {
+    typedef Record<N> T;
+
+    static Expr select(Expr e)
+    {
+        vector<Expr> fields;
+        for (int i = 0; i < N; i++) {
+            fields.push_back(_get(e, i) + _f32(3));
+        }
+        return _new(fields);
+    }
+
+    static Expr filter(Expr e) { return _gt(_get(e, 0), _f32(where_threshold)); }
+
+    static Expr zero()
+    {
+        vector<Expr> fields;
+        for (int i = 0; i < N; i++) {
+            fields.push_back(_f32(0));
+        }
+        return _new(fields);
+    }
+
+    static Expr add(Expr s, Expr d)
+    {
+        vector<Expr> fields;
+        for (int i = 0; i < N; i++) {
+            fields.push_back(_add(_get(s, i), _get(d, i)));
+        }
+        return _new(fields);
+    }
+
+    static T ref_select(T v)
+    {
+        for (int i = 0; i < N; i++) {
+            v.f[i] += 3;
+        }
+        return v;
+    }
+
+    static bool ref_filter(T v) { return v.f[0] > static_cast<float>(where_threshold); }
+    static T ref_zero() { return T{}; }
+
+    static T ref_add(T s, T v)
+    {
+        for (int i = 0; i < N; i++) {
+            s.f[i] += v.f[i];
+        }
+        return s;
+    }
+
+    // field i of an event is the synthetic float value plus i
+    static void fill(region_t* reg, dur_t period, int64_t size)
+    {
+        auto vals = Benchmark::create_in_reg<float>(size);
+        SynthData<float> dataset(period, size);
+        dataset.fill(&vals);
+        for (auto i = get_start_idx(&vals); i <= get_end_idx(&vals); i++) {
+            auto iv = vals.tl[i & vals.mask];
+            if (iv.d == 0) {
+                continue;
+            }
+            auto t = iv.t + iv.d;
+            auto v = *reinterpret_cast<float*>(fetch(&vals, t, i, sizeof(float)));
+            if (get_end_time(reg) < iv.t) {
+                commit_null(reg, iv.t);
+            }
+            commit_data(reg, t);
+            auto* ptr = reinterpret_cast<T*>(fetch(reg, t, get_end_idx(reg), sizeof(T)));
+            for (int k = 0; k < N; k++) {
+                ptr->f[k] = v + k;
+            }
+        }
+        Benchmark::release_reg(&vals);
+    }
+};
+
+template<typename T>
+Op _WidthWindowSum(_sym in, int64_t w)
+{
+    auto window = in[_win(-w, 0)];
+    auto window_sym = _sym("win", window);
+    auto acc = [](Expr s, Expr st, Expr et, Expr d) { return WidthOps<T>::add(s, d); };
+    auto sum = _red(window_sym, WidthOps<T>::zero(), acc);
+    auto sum_sym = _sym("sum", sum);
+    auto wc_op = _op(
+        _iter(0, w),
+        Params{ in },
+        SymTable{ {window_sym, window}, {sum_sym, sum} },
+        _true(),
+        sum_sym);
+    return wc_op;
+}
+
+// Bytes of payload and timeline the query read and wrote in its last run
+class WidthStats : public Benchmark {
+public:
+    int64_t payload_bytes = 0;
+    int64_t timeline_bytes = 0;
+};
+
+template<typename T>
+class WidthBench : public WidthStats {
+public:
+    WidthBench(CompOp op, dur_t period, int64_t w, int64_t size) :
+        op(op), period(period), w(w), size(size)
+    {}
+
+    bool partitionable() override { return true; }
+
+private:
+    Op query() final
+    {
+        auto in_sym = _sym("in", tilt::Type(TiltType<T>::type(), _iter(0, -1)));
+        switch (op) {
+            case CompOp::SELECT:
+                return _Select(in_sym, [](_sym e) { return WidthOps<T>::select(e); });
+            case CompOp::WHERE:
+                return _Where(in_sym, [](_sym e) { return WidthOps<T>::filter(e); });
+            default:
+                return _WidthWindowSum<T>(in_sym, w);
+        }
+    }
+
+    void init() final
+    {
+        in_reg = create_in_reg<T>(size);
+        WidthOps<T>::fill(&in_reg, period, size);
+        auto osize = (op == CompOp::SUM) ? static_cast<int64_t>(ceil((double) size / w)) : size;
+        out_reg = create_out_reg<T>(osize, size);
+        input_bytes = reg_bytes<T>(&in_reg);
+    }
+
+    void execute(intptr_t addr) final
+    {
+        run_query(addr, period * size, size, (op == CompOp::SUM) ? w : 1, &out_reg, &in_reg);
+
+        auto in_entries = get_end_idx(&in_reg) - get_start_idx(&in_reg);
+        auto out_entries = (sink_spec.mode == SinkMode::FULL) ?
+            get_end_idx(&out_reg) - get_start_idx(&out_reg) : sink.count;
+        payload_bytes = (in_entries + out_entries) * sizeof(T);
+        timeline_bytes = (in_entries + out_entries) * sizeof(ival_t);
+    }
+
+    Verdict verify() final
+    {
+        switch (op) {
+            case CompOp::SELECT:
+                return ref_compare(&out_reg, ref_select<T, T>(&in_reg, WidthOps<T>::ref_select));
+            case CompOp::WHERE:
+                return ref_compare(&out_reg, ref_where<T>(&in_reg, WidthOps<T>::ref_filter));
+            default:
+                return ref_compare(&out_reg, ref_window<T, T>(&in_reg, w, period * size,
+                    WidthOps<T>::ref_zero(), WidthOps<T>::ref_add));
+        }
+    }
+
+    void release() final
+    {
+        release_reg(&in_reg);
+        release_reg(&out_reg);
+    }
+
+    CompOp op;
+    dur_t period;
+    int64_t w;
+    int64_t size;
+    region_t in_reg;
+    region_t out_reg;
+};
+
+// Runs testcase width_<op>_<type>, with op one of select, where and sum and
+// type one of i8, i16, i32, i64, f32, f64 and rec2 to rec8
+class ParallelWidthBench : public ParallelBenchmark {
+public:
+    ParallelWidthBench(int threads, const string& testcase, dur_t period, int64_t w, int64_t size)
+    {
+        auto sep = testcase.find('_', 6);
+        if (testcase.rfind("width_", 0) != 0 || sep == string::npos) {
+            throw runtime_error("Invalid width testcase " + testcase);
+        }
+        auto op_name = testcase.substr(6, sep - 6);
+        auto type = testcase.substr(sep + 1);
+
+        CompOp op;
+        if (op_name == "select") {
+            op = CompOp::SELECT;
+        } else if (op_name == "where") {
+            op = CompOp::WHERE;
+        } else if (op_name == "sum") {
+            op = CompOp::SUM;
+        } else {
+            throw runtime_error("Invalid width query " + op_name);
+        }
+
+        for (int i = 0; i < threads; i++) {
+            benchs.push_back(make(type, op, period, w, size));
+        }
+    }
+
+    int64_t payload_bytes()
+    {
+        int64_t bytes = 0;
+        for (auto bench : benchs) {
+            bytes += static_cast<WidthStats*>(bench)->payload_bytes;
+        }
+        return bytes;
+    }
+
+    int64_t timeline_bytes()
+    {
+        int64_t bytes = 0;
+        for (auto bench : benchs) {
+            bytes += static_cast<WidthStats*>(bench)->timeline_bytes;
+        }
+        return bytes;
+    }
+
+private:
+    static Benchmark* make(const string& type, CompOp op, dur_t period, int64_t w, int64_t size)
+    {
+        if (type == "i8") {
+            return new WidthBench<int8_t>(op, period, w, size);
+        } else if (type == "i16") {
+            return new WidthBench<int16_t>(op, period, w, size);
+        } else if (type == "i32") {
+            return new WidthBench<int32_t>(op, period, w, size);
+        } else if (type == "i64") {
+            return new WidthBench<int64_t>(op, period, w, size);
+        } else if (type == "f32") {
+            return new WidthBench<float>(op, period, w, size);
+        } else if (type == "f64") {
+            return new WidthBench<double>(op, period, w, size);
+        } else if (type == "rec2") {
+            return new WidthBench<Record<2>>(op, period, w, size);
+        } else if (type == "rec3") {
+            return new WidthBench<Record<3>>(op, period, w, size);
+        } else if (type == "rec4") {
+            return new WidthBench<Record<4>>(op, period, w, size);
+        } else if (type == "rec5") {
+            return new WidthBench<Record<5>>(op, period, w, size);
+        } else if (type == "rec6") {
+            return new WidthBench<Record<6>>(op, period, w, size);
+        } else if (type == "rec7") {
+            return new WidthBench<Record<7>>(op, period, w, size);
+        } else if (type == "rec8") {
+            return new WidthBench<Record<8>>(op, period, w, size);
+        }
+        throw runtime_error("Invalid payload type " + type);
+    }
+};
+
+#endif  // TILT_BENCH_INCLUDE_TILT_WIDTH_H_
@@ -8,14 +8,15 @@
 using namespace tilt;
 using namespace tilt::tilder;
 
-Op _Yahoo(_sym in, int64_t w)
+// `is_view` tests an entry of `in` for a view event (event_type 1). It is
+// rewritten per layout, e.g. to compare against a dictionary code.
+Op _Yahoo(_sym in, int64_t w, function<Expr(Expr)> is_view = [](Expr d) { return _eq(_get(d, 2), _i64(1)); })
 {
     auto window = in[_win(-w, 0)];
     auto window_sym = _sym("win", window);
 
-    auto acc = [](Expr s, Expr st, Expr et, Expr d) {
-        auto e_type = _get(d, 2);
-        auto flag = _sel(_eq(e_type, _i64(1)), _i32(1), _i32(0));
+    auto acc = [is_view](Expr s, Expr st, Expr et, Expr d) {
+        auto flag = _sel(is_view(d), _i32(1), _i32(0));
         return _add(s, flag);
     };
     auto count = _red(window_sym, _i32(0), acc);
@@ -29,55 +30,132 @@ Op _Yahoo(_sym in, int64_t w)
     return wc_op;
 }
 
+// ROW: Yahoo structs (32 bytes), COLUMNAR: the event_type column alone,
+// DICT: dictionary encoded YahooCode structs (4 bytes), DICT_COLUMNAR: the
+// encoded event_type column alone (1 byte)
+enum class YahooLayout { ROW, COLUMNAR, DICT, DICT_COLUMNAR };
+
+// Dictionaries of the Yahoo columns, shared by all partitions of a query so
+// that one compiled query matches the codes of every partition
+struct YahooDicts {
+    Dictionary<long, int8_t> user_id;
+    Dictionary<long, int8_t> camp_id;
+    Dictionary<long, int8_t> event_type;
+};
+
 class YahooBench : public Benchmark {
 public:
-    YahooBench(dur_t period, int64_t w, int64_t size) :
-        period(period), size(size), w(w)
+    YahooBench(dur_t period, int64_t w, int64_t size, YahooLayout layout = YahooLayout::ROW,
+            shared_ptr<YahooDicts> dicts = make_shared<YahooDicts>()) :
+        period(period), size(size), w(w), layout(layout), dicts(dicts)
     {}
 
 private:
     Op query() final
     {
-        auto in_sym = _sym("in", tilt::Type(types::STRUCT<long, long, long, long>(), _iter(0, -1)));
-        return _Yahoo(in_sym, w);
+        switch (layout) {
+            case YahooLayout::COLUMNAR: {
+                auto in_sym = _sym("event_type", tilt::Type(types::INT64, _iter(0, -1)));
+                return _Yahoo(in_sym, w, [](Expr d) { return _eq(d, _i64(1)); });
+            }
+            case YahooLayout::DICT: {
+                // query literals are interned when the query is built, before ingest
+                auto in_sym = _sym("in", tilt::Type(types::STRUCT<int8_t, int8_t, int8_t, int8_t>(), _iter(0, -1)));
+                auto view = dicts->event_type.encode(1);
+                return _Yahoo(in_sym, w, [view](Expr d) { return _eq(_get(d, 2), _i8(view)); });
+            }
+            case YahooLayout::DICT_COLUMNAR: {
+                auto in_sym = _sym("event_type", tilt::Type(types::INT8, _iter(0, -1)));
+                auto view = dicts->event_type.encode(1);
+                return _Yahoo(in_sym, w, [view](Expr d) { return _eq(d, _i8(view)); });
+            }
+            default: {
+                auto in_sym = _sym("in", tilt::Type(types::STRUCT<long, long, long, long>(), _iter(0, -1)));
+                return _Yahoo(in_sym, w);
+            }
+        }
     }
 
     void init() final
     {
-        in_reg = create_reg<Yahoo>(size);
+        in_reg = create_in_reg<Yahoo>(size);
         float osize = (float)size / (float)w;
         out_reg = create_reg<int>(ceil(osize));
 
         YahooData dataset(period, size);
         dataset.fill(&in_reg);
+
+        // ingest-time transcoding, the query reads `enc_reg` which shares the
+        // timeline of `in_reg`
+        switch (layout) {
+            case YahooLayout::COLUMNAR:
+                enc_reg = column_reg(&in_reg, &Yahoo::event_type);
+                input_bytes = reg_bytes<long>(&enc_reg);
+                break;
+            case YahooLayout::DICT:
+                enc_reg = map_reg<Yahoo, YahooCode>(&in_reg, [this](const Yahoo& y) {
+                    return YahooCode{ dicts->user_id.encode(y.user_id), dicts->camp_id.encode(y.camp_id),
+                        dicts->event_type.encode(y.event_type), 0 };
+                });
+                input_bytes = reg_bytes<YahooCode>(&enc_reg);
+                break;
+            case YahooLayout::DICT_COLUMNAR:
+                enc_reg = map_reg<Yahoo, int8_t>(&in_reg, [this](const Yahoo& y) {
+                    return dicts->event_type.encode(y.event_type);
+                });
+                input_bytes = reg_bytes<int8_t>(&enc_reg);
+                break;
+            default:
+                input_bytes = reg_bytes<Yahoo>(&in_reg);
+                return;
+        }
+        // the reference needs the original records
+        if (!verify_output) {
+            delete [] in_reg.data;
+            in_reg.data = nullptr;
+        }
     }
 
     void execute(intptr_t addr) final
     {
         auto query = (region_t* (*)(ts_t, ts_t, region_t*, region_t*)) addr;
-        query(0, period * size, &out_reg, &in_reg);
+        query(0, period * size, &out_reg, (layout == YahooLayout::ROW) ? &in_reg : &enc_reg);
+    }
+
+    Verdict verify() final
+    {
+        auto ref = ref_window<Yahoo, int32_t>(&in_reg, w, period * size, 0,
+            [](int32_t s, const Yahoo& y) { return s + (y.event_type == 1); });
+        return ref_compare(&out_reg, ref);
     }
 
     void release() final
     {
+        if (layout != YahooLayout::ROW) {
+            release_col(&enc_reg);
+        }
         release_reg(&in_reg);
         release_reg(&out_reg);
     }
 
     region_t in_reg;
+    region_t enc_reg;
     region_t out_reg;
 
     int64_t size;
     dur_t period;
     int64_t w;
+    YahooLayout layout;
+    shared_ptr<YahooDicts> dicts;
 };
 
 class ParallelYahooBench : public ParallelBenchmark {
 public:
-    ParallelYahooBench(int threads, dur_t period, int64_t w, int64_t size)
+    ParallelYahooBench(int threads, dur_t period, int64_t w, int64_t size, YahooLayout layout = YahooLayout::ROW)
     {
+        auto dicts = make_shared<YahooDicts>();
         for (int i = 0; i < threads; i++) {
-            benchs.push_back(new YahooBench(period, w, size));
+            benchs.push_back(new YahooBench(period, w, size, layout, dicts));
         }
     }
 };
@@ -0,0 +1,18 @@
+#! /usr/bin/bash
+
+# Intra-query parallelism: one copy of the data, one query invocation split
+# into time partitions run by INTRA threads. Prints
+# "testcase,intra,throughput" per run; compare with THREADS copies in run.sh.
+# Only the testcases whose query keeps no recursive state can be split.
+
+SIZE=${SIZE:-100000000}
+
+for testcase in select where aggregate sum64 innerjoin normalize normalize_stream vecaggregate
+do
+    for intra in 1 2 4 8 16
+    do
+        ./build/main $testcase $SIZE 1 --intra=$intra "$@" \
+            | awk -F, -v t=$testcase -v n=$intra '/Throughput/ { print t "," n "," $4 }' \
+            | tr -d ' '
+    done
+done
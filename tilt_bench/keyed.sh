@@ -0,0 +1,20 @@
+#! /usr/bin/bash
+
+# Keyed trading pipelines against the number of symbols in the feed.
+# Per-symbol state is ~(w_long + 4) * 4 bytes for algotrading (w_long = 50)
+# and ~(window + 5) * 4 bytes for rsi (window = 14).
+# Prints one "query,symbols,throughput" line per run.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+
+for query in keyed_algotrading keyed_rsi
+do
+    for symbols in 1 10 100 1000 10000 100000
+    do
+        ./build/main $query $SIZE $THREADS --symbols=$symbols \
+            | grep "Throughput(M/s)" \
+            | awk -F, -v q=$query -v s=$symbols '{ print q "," s "," $4 }' \
+            | tr -d ' '
+    done
+done
@@ -0,0 +1,19 @@
+#! /usr/bin/bash
+
+# Micro-batch latency: runs each query over batches of 1 to 1M input events.
+# Prints "testcase,batch,throughput,p50_us,p99_us,p999_us,max_us" per run. The
+# batch is the one actually run, after rounding up to the query's window.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+
+for testcase in select where aggregate innerjoin normalize rsi algotrading pantom
+do
+    for batch in 1 10 100 1000 10000 100000 1000000
+    do
+        ./build/main $testcase $SIZE $THREADS --batch=$batch "$@" \
+            | awk -F, -v t=$testcase \
+                '/Throughput/ { tp = $4 } /Latency/ { b = $4; lat = $5 "," $6 "," $7 "," $8 } END { print t "," b "," tp "," lat }' \
+            | tr -d ' '
+    done
+done
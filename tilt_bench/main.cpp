@@ -1,29 +1,9 @@
 #include <iostream>
 #include <iomanip>
+#include <map>
 #include <sys/resource.h>
 
-#include "tilt_select.h"
-#include "tilt_where.h"
-#include "tilt_aggregate.h"
-#include "tilt_sumwhere.h"
-#include "tilt_average.h"
-#include "tilt_var.h"
-#include "tilt_alterdur.h"
-#include "tilt_sliding_sum.h"
-#include "tilt_innerjoin.h"
-#include "tilt_outerjoin.h"
-#include "tilt_norm.h"
-#include "tilt_ma.h"
-#include "tilt_rsi.h"
-#include "tilt_qty.h"
-#include "tilt_impute.h"
-#include "tilt_peak.h"
-#include "tilt_resample.h"
-#include "tilt_kurt.h"
-#include "tilt_eg.h"
-#include "tilt_yahoo.h"
-#include "bd_tilt_select.h"
-#include "bd_tilt_where.h"
+#include "tilt_registry.h"
 
 using namespace std;
 
@@ -47,183 +27,165 @@ int main(int argc, char** argv)
     string testcase = (argc > 1) ? argv[1] : "select";
     int64_t size = (argc > 2) ? atoi(argv[2]) : 100000000;
     int threads = (argc > 3) ? atoi(argv[3]) : 1;
-    int64_t period = 1;
-
-    double time = 0;
-
-    if (testcase == "select") {
-        ParallelSelectBench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "select64") {
-        ParallelSelect64Bench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "select8") {
-        ParallelSelect8Bench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "select_loopIR") {
-        SelectBench bench(period, size);
-        bench.print_loopIR("select_loopIR.txt");
-    } else if (testcase == "select_llvmIR") {
-        SelectBench bench(period, size);
-        bench.print_llvmIR("select_llvmIR.txt");
-    } else if (testcase == "where") {
-        ParallelWhereBench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "where64") {
-        ParallelWhere64Bench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "where8") {
-        ParallelWhere8Bench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "where_loopIR") {
-        WhereBench bench(period, size);
-        bench.print_loopIR("where_loopIR.txt");
-    } else if (testcase == "where_llvmIR") {
-        WhereBench bench(period, size);
-        bench.print_llvmIR("where_llvmIR.txt");
-    } else if (testcase == "aggregate") {
-        ParallelAggregateBench bench(threads, period, size, 1000 * period);
-        time = bench.run();
-    } else if (testcase == "aggregate_loopIR") {
-        AggregateBench bench(period, size, 1000 * period);
-        bench.print_loopIR("agg_loopIR.txt");
-    } else if (testcase == "sum64") {
-        ParallelSum64Bench bench(threads, period, size, 1000 * period);
-        time = bench.run();
-    } else if (testcase == "sum8") {
-        ParallelSum8Bench bench(threads, period, size, 1000 * period);
-        time = bench.run();
-    } else if (testcase == "sumwhere") {
-        ParallelSumWhere64Bench bench(threads, period, size, 1000 * period);
-        time = bench.run();
-    } else if (testcase == "var64onepass") {
-        ParallelVar64OnePassBench bench(threads, period, 1000 * period, size);
-        time = bench.run();
-    } else if (testcase == "avg") {
-        ParallelAverageBench bench(threads, period, size, 1000 * period);
-        time = bench.run();
-    } else if (testcase == "avg_loopIR") {
-        AverageBench bench(period, size, 1000 * period);
-        bench.print_loopIR("avg_loopIR.txt");
-    } else if (testcase == "avgonepass") {
-        ParallelAverageOnePassBench bench(threads, period, size, 1000 * period);
-        time = bench.run();
-    } else if (testcase == "avgonepass_loopIR") {
-        AverageOnePassBench bench(period, size, 1000 * period);
-        bench.print_loopIR("avgonepass_loopIR.txt");
-    } else if (testcase == "aggregate_llvmIR") {
-        AggregateBench bench(period, size, 1000 * period);
-        bench.print_llvmIR("agg_llvmIR.txt");
-    } else if (testcase == "naivesum") {
-        ParallelNaiveSlidingSumBench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "naivesum_loopIR") {
-        NaiveSlidingSumBench bench(period, size);
-        bench.print_loopIR("naivesum_loopIR.txt");
-    } else if (testcase == "incsum") {
-        ParallelIncSlidingSumBench bench(threads, period, size);
-        time = bench.run();
-    } else if (testcase == "incsum_loopIR") {
-        IncSlidingSumBench bench(period, size);
-        bench.print_loopIR("incsum_loopIR.txt");
-    }  else if (testcase == "alterdur") {
-        AlterDurBench bench(3, 2, size);
-        time = bench.run();
-    } else if (testcase == "alterdur_loopIR") {
-        AlterDurBench bench(3, 2, size);
-        bench.print_loopIR("alterdur_loopIR.txt");
-    } else if (testcase == "innerjoin") {
-        InnerJoinBench bench(period, period, size);
-        time = bench.run();
-    } else if (testcase == "innerjoin_loopIR") {
-        InnerJoinBench bench(period, period, size);
-        bench.print_loopIR("innerjoin_loopIR.txt");
-    } else if (testcase == "innerjoin_llvmIR") {
-        InnerJoinBench bench(period, period, size);
-        bench.print_llvmIR("innerjoin_llvmIR.txt");
-    } else if (testcase == "outerjoin") {
-        OuterJoinBench bench(period, period, size);
-        time = bench.run();
-    } else if (testcase == "normalize") {
-        ParallelNormBench bench(threads, period, 10000, size);
-        time = bench.run();
-    } else if (testcase == "norm64onepass") {
-        ParallelNorm64OnePassBench bench(threads, period, 1000 * period, size);
-        time = bench.run();
-    } else if (testcase == "fillmean") {
-        ParallelImputeBench bench(threads, period, 10000, size);
-        time = bench.run();
-    } else if (testcase == "resample") {
-        ParallelResampleBench bench(threads, 4, 5, 1000, size);
-        time = bench.run();
-    } else if (testcase == "algotrading") {
-        ParallelMOCABench bench(threads, period, 20, 50, 100, size);
-        time = bench.run();
-    } else if (testcase == "moca_loopIR") {
-        MOCABench bench(period, 20, 50, 100, size);
-        bench.print_loopIR("moca_loopIR.txt");
-    } else if (testcase == "rsi") {
-        ParallelRSIBench bench(threads, period, 14, 100, size);
-        time = bench.run();
-    } else if (testcase == "largeqty") {
-        ParallelLargeQtyBench bench(threads, period, 10, 100, size);
-        time = bench.run();
-    } else if (testcase == "pantom") {
-        ParallelPeakBench bench(threads, period, 30, 100, size);
-        time = bench.run();
-    } else if (testcase == "kurtosis") {
-        ParallelKurtBench bench(threads, period, 100, size);
-        time = bench.run();
-    } else if (testcase == "eg1") {
-        Eg1Bench bench(period, size, 10, 20, size);
-        time = bench.run();
-    } else if (testcase == "eg2") {
-        Eg2Bench bench(period, size, 10, 20, size);
-        time = bench.run();
-    } else if (testcase == "eg3") {
-        Eg3Bench bench(period, size, 10, 20, size);
-        time = bench.run();
-    } else if (testcase == "eg4") {
-        Eg4Bench bench(period, size, 10, 20, size);
-        time = bench.run();
-    } else if (testcase == "eg5") {
-        Eg5Bench bench(period, size, 10, 20, size);
-        time = bench.run();
-    } else if (testcase == "eg6") {
-        Eg6Bench bench(period, size, 10, 20, size);
-        time = bench.run();
-    } else if (testcase == "eg7") {
-        Eg7Bench bench(period, size, 10, 20, size);
-        time = bench.run();
-    } else if (testcase == "eg1_loopIR") {
-        Eg1Bench bench(period, size, 10, 20, size);
-        bench.print_loopIR("eg1_loopIR.txt");
-    } else if (testcase == "eg2_loopIR") {
-        Eg2Bench bench(period, size, 10, 20, size);
-        bench.print_loopIR("eg2_loopIR.txt");
-    } else if (testcase == "eg7_loopIR") {
-        Eg7Bench bench(period, size, 10, 20, size);
-        bench.print_loopIR("eg7_loopIR.txt");
-    } else if (testcase == "yahoo") {
-        ParallelYahooBench bench(threads, period, 100 * period, size);
-        time = bench.run();
-    } else if (testcase == "bdselect") {
-        ParallelBDSelectBench bench(threads, period, 100 * period, size);
-        time = bench.run();
-    } else if (testcase == "bdselect_loopIR") {
-        BDSelectBench bench(period, 100 * period, size);
-        bench.print_loopIR("bdselect_loopIR.txt");
-    } else if (testcase == "bdwhere") {
-        ParallelBDWhereBench bench(threads, period, 100 * period, size);
-        time = bench.run();
-    } else if (testcase == "bdwhere_loopIR") {
-        BDWhereBench bench(period, 100 * period, size);
-        bench.print_loopIR("bdwhere_loopIR.txt");
-    } else {
+
+    // optional trailing flags of the form --name=value; a sweep takes its
+    // sizes and threads from the spec, so its flags start right away
+    map<string, string> opts;
+    for (int i = (testcase == "sweep") ? 2 : 4; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            throw runtime_error("Invalid option " + arg);
+        }
+        auto eq = arg.find('=');
+        opts[arg.substr(2, eq - 2)] = (eq == string::npos) ? "" : arg.substr(eq + 1);
+    }
+    auto opt = [&opts](string name, string def) { return opts.count(name) ? opts[name] : def; };
+
+    // ticks between events; non-periodic arrivals need a period > 1 to jitter
+    int64_t period = stol(opt("period", "1"));
+    missing_ratio = stod(opt("missing", "0"));
+
+    arrival_spec.set_arrival(opt("arrival", "periodic"));
+    arrival_spec.set_duration(opt("duration", "full"));
+    arrival_spec.disorder = stol(opt("disorder", "0"));
+    arrival_spec.seed = stoul(opt("seed", "42"));
+
+    sink_spec.set_mode(opt("sink", "full"));
+    sink_spec.chunk = stol(opt("chunk", "65536"));
+    sink_spec.thread = stoi(opt("sink_thread", "0"));
+
+    micro_batch = stol(opt("batch", "0"));
+    intra_threads = stoi(opt("intra", "1"));
+
+    where_threshold = stod(opt("threshold", "0"));
+    simd_flag = opt("simd", "auto");
+    where_kernel = opt("where_kernel", "compress");
+    set_where_selectivity(opt("selectivity", ""));
+    cse_enabled = stoi(opt("cse", "1"));
+    set_tier_mode(opt("tiered", "off"));
+    aot_dir = opt("aot", "");
+
+    verify_output = stoi(opt("verify", "0"));
+    verify_tol = stod(opt("verify_tol", "1e-4"));
+    if (verify_output && sink_spec.mode != SinkMode::FULL) {
+        throw runtime_error("--verify needs the full output region (--sink=full)");
+    }
+
+    if (testcase == "sweep") {
+        auto results = Sweep(opt("spec", "sweep.spec")).run();
+        ofstream file;
+        if (opts.count("out")) {
+            file.open(opts["out"]);
+        }
+        ostream& os = opts.count("out") ? file : cout;
+        if (opt("format", "csv") == "json") {
+            Sweep::write_json(os, results);
+        } else {
+            Sweep::write_csv(os, results);
+        }
+        return 0;
+    }
+
+    // <testcase>_loopIR and <testcase>_llvmIR write the IR of the query to
+    // <testcase>_loopIR.txt and <testcase>_llvmIR.txt instead of running it
+    auto name = testcase;
+    string ir;
+    for (string suffix : {"_loopIR", "_llvmIR"}) {
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            name = name.substr(0, name.size() - suffix.size());
+            ir = suffix;
+        }
+    }
+
+    auto registry = bench_registry();
+    if (!registry.count(name)) {
         throw runtime_error("Invalid testcase");
     }
+    auto& entry = registry.at(name);
+    SweepPoint point{name, period, size, threads, {}};
+    for (auto& param : entry.params) {
+        point.params[param.first] = stol(opt(param.first, to_string(param.second)));
+    }
+
+    if (!ir.empty()) {
+        point.threads = 1;
+        unique_ptr<ParallelBenchmark> bench(entry.make(point));
+        if (ir == "_loopIR") {
+            bench->benchs[0]->print_loopIR(testcase + ".txt");
+        } else {
+            bench->benchs[0]->print_llvmIR(testcase + ".txt");
+        }
+        return 0;
+    }
+
+    auto res = run_bench(entry, point);
+    double time = res.time_us;
+
+    if (micro_batch > 0 && res.batch_events == 0) {
+        throw runtime_error("Testcase " + testcase + " does not support --batch");
+    }
 
     cout << "Throughput(M/s), " << testcase << ", " << threads << ", " << setprecision(3) << (size * threads) / time << endl;
+    if (sink_spec.mode != SinkMode::FULL) {
+        cout << "Output(count, checksum), " << testcase << ", " << threads << ", " << res.out_count << ", " << hex << res.out_checksum << dec << endl;
+    }
+    if (verify_output) {
+        cout << "Verify, " << testcase << ", " << threads << ", "
+            << (!res.verdict.checked ? "UNCHECKED" : (res.verdict.mismatches == 0 ? "OK" : "FAIL")) << ", "
+            << res.verdict.entries << ", " << res.verdict.mismatches << ", " << hex << res.verdict.checksum << dec << endl;
+    }
+    if (res.latency.total > 0 && !res.open_loop) {
+        cout << "Latency(us), " << testcase << ", " << threads << ", " << res.batch_events << ", " << setprecision(3)
+            << res.latency.percentile(0.5) / 1e3 << ", " << res.latency.percentile(0.99) / 1e3 << ", "
+            << res.latency.percentile(0.999) / 1e3 << ", " << res.latency.max_val / 1e3 << endl;
+    }
+    if (res.open_loop) {
+        cout << "OpenLoop(us), " << testcase << ", " << threads << ", " << setprecision(3) << point.params["rate"] / 1e6 << ", "
+            << res.latency.percentile(0.5) / 1e3 << ", " << res.latency.percentile(0.99) / 1e3 << ", "
+            << res.latency.percentile(0.999) / 1e3 << ", " << res.latency.max_val / 1e3 << endl;
+    }
+    if (res.payload_bytes > 0) {
+        cout << "Bandwidth(GB/s), " << testcase << ", " << threads << ", " << setprecision(3)
+            << res.payload_bytes / (time * 1e3) << ", " << res.timeline_bytes / (time * 1e3) << endl;
+    }
+    if (tier_mode != TierMode::OFF && !res.tier.samples.empty()) {
+        cout << "Startup(ms), " << testcase << ", " << threads << ", " << setprecision(3)
+            << res.tier.first_result_us / 1e3 << ", " << res.tier.switch_us / 1e3 << ", " << res.tier.compile_us / 1e3 << endl;
+        if (opts.count("timeline")) {
+            ofstream file(opts["timeline"]);
+            write_tier_samples(file, res.tier.samples);
+        }
+    }
+    if (compile_stats.jit + compile_stats.aot_built + compile_stats.aot_loaded > 0) {
+        cout << "Compile(ms), " << testcase << ", " << threads << ", " << compile_stats.mode() << ", "
+            << setprecision(3) << compile_stats.us / 1e3 << endl;
+    }
+    if (res.fused_bytes > 0) {
+        cout << "Fusion(bytes), " << testcase << ", " << threads << ", " << res.fused_bytes << ", " << res.ring_bytes << endl;
+    }
+    if (where_blocks[0] + where_blocks[1] + where_blocks[2] > 0) {
+        cout << "Adaptive(blocks), " << testcase << ", " << threads << ", " << where_blocks[0] << ", "
+            << where_blocks[1] << ", " << where_blocks[2] << ", " << where_switches << endl;
+    }
+    for (auto& op : res.profile) {
+        if (op.calls > 0) {
+            cout << "Profile, " << testcase << ", " << threads << ", " << op.name << ", " << op.events_in << ", "
+                << op.events_out << ", " << op.calls << ", " << op.cycles << ", "
+                << setprecision(3) << (double) op.cycles / max<int64_t>(op.events_in, 1) << endl;
+        }
+    }
+    if (cse_eliminated > 0) {
+        cout << "CSE(nodes), " << testcase << ", " << threads << ", " << cse_eliminated << endl;
+    }
+    if (arena_state_bytes > 0) {
+        cout << "State(bytes), " << testcase << ", " << threads << ", " << arena_state_bytes << endl;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cout << "PeakRSS(MB), " << testcase << ", " << threads << ", " << setprecision(3) << usage.ru_maxrss / 1024.0 << endl;
+    if (res.in_bytes > 0) {
+        cout << "Bytes/event, " << testcase << ", " << threads << ", " << setprecision(3) << (double) res.in_bytes / (size * threads) << endl;
+    }
 
     return 0;
 }
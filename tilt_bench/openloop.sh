@@ -0,0 +1,28 @@
+#! /usr/bin/bash
+
+# Open-loop runs at a rising target rate, doubling from RATE events/s until
+# the query saturates: the achieved rate falls 5% short of the target or the
+# p99 latency exceeds BOUND_US. Prints
+# "testcase,target_mps,achieved_mps,p50_us,p99_us,p999_us,max_us" per run.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+RATE=${RATE:-100000}
+BOUND_US=${BOUND_US:-1000}
+
+for testcase in openloop_select openloop_where openloop_aggregate openloop_normalize
+do
+    rate=$RATE
+    while true
+    do
+        line=$(./build/main $testcase $SIZE $THREADS --rate=$rate "$@" \
+            | awk -F, -v t=$testcase \
+                '/Throughput/ { tp = $4 } /OpenLoop/ { target = $4; lat = $5 "," $6 "," $7 "," $8 } END { print t "," target "," tp "," lat }' \
+            | tr -d ' ')
+        echo $line
+        if awk -F, -v b=$BOUND_US '{ exit !($3 < 0.95 * $2 || $5 > b) }' <<< "$line"; then
+            break
+        fi
+        rate=$((rate * 2))
+    done
+done
@@ -0,0 +1,24 @@
+#! /usr/bin/bash
+
+# Fused vs pipeline-parallel execution of the multi-stage queries, over the
+# same time slices. Prints "testcase,batch,throughput,p50_us,p99_us,p999_us,max_us"
+# per run; the latency is per slice, from the first stage starting it to the
+# last stage finishing it. Pass --sink=checksum to check that both variants
+# produce the same output.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+
+for query in pantom normalize query1
+do
+    for batch in 1000 10000 100000
+    do
+        for mode in fused pipe
+        do
+            ./build/main ${query}_$mode $SIZE $THREADS --batch=$batch "$@" \
+                | awk -F, -v t=${query}_$mode \
+                    '/Throughput/ { tp = $4 } /Latency/ { b = $4; lat = $5 "," $6 "," $7 "," $8 } END { print t "," b "," tp "," lat }' \
+                | tr -d ' '
+        done
+    done
+done
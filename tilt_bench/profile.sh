@@ -0,0 +1,16 @@
+#! /usr/bin/bash
+
+# Per-operator profile of the composite queries, each operator compiled and
+# run as a pipeline stage. Needs a build configured with -DPROFILE_OPS=ON.
+# Prints "testcase,operator,events_in,events_out,calls,cycles,cycles_per_event"
+# per operator. The fused plans run as one stage and are not profiled.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+
+for testcase in pantom_pipe normalize_pipe query1_pipe
+do
+    ./build/main $testcase $SIZE $THREADS "$@" \
+        | awk -F, '/Profile/ { print $2 "," $4 "," $5 "," $6 "," $7 "," $8 "," $9 }' \
+        | tr -d ' '
+done
@@ -0,0 +1,20 @@
+#! /usr/bin/bash
+
+# Compiled tumbling window reductions against the multi-accumulator kernels
+# at every vector width. Prints "query,kernel,throughput" per run.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for query in aggregate sum64 sum8 avgonepass var64onepass max min
+do
+    if [[ $query != max && $query != min ]]; then
+        ./build/main $query $SIZE $THREADS "$@" \
+            | awk -F, -v q=$query '/Throughput/ { print q ",compiled," $4 }' | tr -d ' '
+    fi
+    for simd in scalar avx2 avx512
+    do
+        ./build/main vec$query $SIZE $THREADS --simd=$simd "$@" \
+            | awk -F, -v q=$query -v k=$simd '/Throughput/ { print q "," k "," $4 }' | tr -d ' '
+    done
+done
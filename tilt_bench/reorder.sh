@@ -0,0 +1,19 @@
+#! /usr/bin/bash
+
+# Cost of watermark-driven reordering: ingests a stream delivered out of order
+# within DISORDER ticks, at one event every PERIOD ticks, into a region.
+# Prints "disorder,period,throughput" per run; disorder 0 is the in-order
+# baseline. Pass e.g. --arrival=poisson for irregular streams.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for period in 1 10 100
+do
+    for disorder in 0 10 100 1000 10000 100000 1000000
+    do
+        ./build/main reorder $SIZE $THREADS --period=$period --disorder=$disorder "$@" \
+            | awk -F, -v d=$disorder -v p=$period '/Throughput/ { print d "," p "," $4 }' \
+            | tr -d ' '
+    done
+done
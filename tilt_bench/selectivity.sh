@@ -0,0 +1,22 @@
+#! /usr/bin/bash
+
+# Where kernels across selectivities from 0.1% to 99.9%, on inputs shaped by
+# --selectivity to pass the predicate at exactly that rate, and on an input
+# whose selectivity shifts between phases. The adaptive kernel picks one of
+# the others per block of events.
+# Prints "type,selectivity,kernel,throughput" per run.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for type in i8 i32 f32 i64
+do
+    for sel in 0.001 0.01 0.05 0.1 0.25 0.5 0.75 0.9 0.95 0.99 0.999 0.001,0.5,0.999,0.3
+    do
+        for kernel in branch predicated compress adaptive
+        do
+            ./build/main compactwhere_$type $SIZE $THREADS --selectivity=$sel --where_kernel=$kernel "$@" \
+                | awk -F, -v ty=$type -v s=$sel -v k=$kernel '/Throughput/ { print ty "," s "," k "," $4 }' | tr -d ' '
+        done
+    done
+done
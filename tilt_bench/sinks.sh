@@ -0,0 +1,24 @@
+#! /usr/bin/bash
+
+# Output modes: full output region vs bounded rings drained by a sink.
+# Prints "testcase,sink,sink_thread,throughput,peak_rss_mb" per run.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for testcase in select where aggregate innerjoin
+do
+    for sink in full count checksum file:/tmp/tilt_sink
+    do
+        for sink_thread in 0 1
+        do
+            ./build/main $testcase $SIZE $THREADS --sink=$sink --sink_thread=$sink_thread \
+                | awk -F, -v t=$testcase -v s=$sink -v st=$sink_thread \
+                    '/Throughput/ { tp = $4 } /PeakRSS/ { rss = $4 } END { print t "," s "," st "," tp "," rss }' \
+                | tr -d ' '
+            if [ $sink == full ]; then
+                break
+            fi
+        done
+    done
+done
@@ -0,0 +1,10 @@
+#! /usr/bin/bash
+
+# Parameter sweep in one process: every query is compiled once per distinct
+# generated code and reused for the other sizes and thread counts.
+# Prints the results as CSV; pass --format=json or --out=<file> to change that,
+# or SPEC=<file> for another sweep.
+
+SPEC=${SPEC:-"testcase=select,where,aggregate,normalize;size=1000000,10000000;threads=1,2,4;w=100,1000;window=1000,10000"}
+
+./build/main sweep --spec="$SPEC" "$@"
@@ -0,0 +1,21 @@
+#! /usr/bin/bash
+
+# Startup of queries compiled before running (jit) or compiled in the
+# background while tier 0 runs (tiered): the native baseline of aggregate,
+# sum64, sum8 and normalize, the query graph interpreter for the rest. Prints
+# "testcase,mode,first_result_ms,switch_ms,compile_ms,throughput" per run and
+# leaves the throughput over time of every run in tiered_<testcase>_<mode>.csv.
+
+SIZE=${SIZE:-10000000}
+THREADS=${THREADS:-1}
+
+for testcase in aggregate sum64 sum8 normalize select where avg fillmean resample rsi
+do
+    for mode in jit tiered
+    do
+        ./build/main $testcase $SIZE $THREADS --tiered=$mode --timeline=tiered_${testcase}_$mode.csv "$@" \
+            | awk -F, -v tc=$testcase -v m=$mode \
+                '/Throughput/ { tp = $4 } /Startup/ { st = $4 "," $5 "," $6 } END { print tc "," m "," st "," tp }' \
+            | tr -d ' '
+    done
+done
@@ -0,0 +1,38 @@
+#! /usr/bin/bash -e
+
+# Checks every query that has a scalar reference implementation.
+# Prints "testcase,status,entries,mismatches,checksum" per run and fails if
+# any output differs from its reference.
+
+SIZE=${SIZE:-1000000}
+THREADS=${THREADS:-1}
+STATUS=0
+
+for testcase in select select64 select8 where where64 where8 \
+    aggregate sum64 sum8 sumwhere avg avgonepass innerjoin \
+    normalize normalize_fused normalize_pipe kurtosis rsi algotrading pantom pantom_fused pantom_pipe \
+    largeqty largeqty_col reorder \
+    width_select_i16 width_where_i32 width_sum_f64 width_select_rec4 width_sum_rec8 \
+    compactwhere_i8 compactwhere_i32 compactwhere_f64 \
+    vecaggregate vecsum64 vecsum8 vecmax vecmin vecavgonepass vecvar64onepass \
+    pantom_stream normalize_stream \
+    yahoo yahoo_col yahoo_dict yahoo_dict_col
+do
+    line=$(./build/main $testcase $SIZE $THREADS --verify=1 "$@" | grep Verify | awk -F, '{ print $2 "," $4 "," $5 "," $6 "," $7 }' | tr -d ' ')
+    echo $line
+    if [[ $line != *,OK,* ]]; then
+        STATUS=1
+    fi
+done
+
+for kernel in branch predicated adaptive
+do
+    line=$(./build/main compactwhere_i32 $SIZE $THREADS --verify=1 --where_kernel=$kernel --selectivity=0.001,0.5,0.999 "$@" \
+        | grep Verify | awk -F, -v k=$kernel '{ print $2 "/" k "," $4 "," $5 "," $6 "," $7 }' | tr -d ' ')
+    echo $line
+    if [[ $line != *,OK,* ]]; then
+        STATUS=1
+    fi
+done
+
+exit $STATUS
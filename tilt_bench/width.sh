@@ -0,0 +1,22 @@
+#! /usr/bin/bash
+
+# Payload width scaling of select, where and tumbling sum (1000 events per
+# window). Prints "query,type,bytes/event,throughput,payload GB/s,timeline GB/s"
+# per run; a query whose GB/s stays flat as the payload grows is memory-bound.
+
+SIZE=${SIZE:-100000000}
+THREADS=${THREADS:-1}
+
+for query in select where sum
+do
+    for type in i8 i16 i32 i64 f32 f64 rec2 rec3 rec4 rec5 rec6 rec7 rec8
+    do
+        ./build/main width_${query}_${type} $SIZE $THREADS "$@" \
+            | awk -F, -v q=$query -v ty=$type '
+                /Throughput/ { tput = $4 }
+                /Bytes\/event/ { bpe = $4 }
+                /Bandwidth/ { pay = $4; tl = $5 }
+                END { print q "," ty "," bpe "," tput "," pay "," tl }' \
+            | tr -d ' '
+    done
+done
@@ -0,0 +1,16 @@
+#! /usr/bin/bash
+
+# YSB on TiLT in every record layout, scaling threads at a fixed total size.
+# Prints "testcase,threads,throughput,bytes_per_event" per run.
+
+SIZE=${SIZE:-320000000}
+
+for testcase in yahoo yahoo_col yahoo_dict yahoo_dict_col
+do
+    for threads in 1 2 4 8 16
+    do
+        ./build/main $testcase $((SIZE / threads)) $threads \
+            | awk -F, -v t=$testcase '/Throughput/ { th = $3; tp = $4 } /Bytes/ { bpe = $4 } END { print t "," th "," tp "," bpe }' \
+            | tr -d ' '
+    done
+done